@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core/Core.h"
+#include <functional>
 
 #if defined(TINY2D_AS_SHAREDLIB) 
 #   if defined(TINY2D_BUILD) 
@@ -23,18 +24,42 @@
 #endif
 
 struct ViewData;
+struct StaticBatch;
 
 namespace Tiny2D {
 
 	using std::uint32_t;
 	using std::uint8_t;
 	typedef Core::Ref<ViewData> ViewHandle;
+	typedef Core::Ref<StaticBatch> StaticBatchHandle;
+
+	struct DrawContext;
 
 	struct Stats
 	{
 		uint32_t LineCount = 0;
 		uint32_t quadCount = 0;
 		uint32_t boxCount = 0;
+
+		uint64_t bufferCapacity = 0;      // bytes held by the upload buffers of the view, across frames in flight
+		uint64_t bufferPeak = 0;          // highest per-frame usage of a single draw context in bytes
+		uint32_t bufferReallocations = 0; // upload buffers created since the view was created
+		uint32_t flushCount = 0;          // times the draws were recorded and submitted early to stay within memoryBudget
+		uint64_t flushBytes = 0;          // upload bytes those flushes submitted
+		uint32_t flushFallbacks = 0;      // overflows under OverflowPolicy::Flush that dropped the new draws instead, see ViewDesc::submit
+
+		// primitives refused or discarded by the overflow policy
+		uint32_t droppedLines = 0;
+		uint32_t droppedQuads = 0;
+		uint32_t droppedBoxes = 0;
+	};
+
+	enum class OverflowPolicy : uint8_t
+	{
+		Flush,      // submit what has been drawn so far through ViewDesc::submit and reuse the memory once the GPU has read it.
+		            // Without submit, and for contexts from AcquireDrawContext, new draws are dropped instead (Stats::flushFallbacks)
+		DropNew,    // refuse the draws that don't fit
+		DropAll,    // discard everything the draw context has recorded this frame, in every pass, to make room
 	};
 
 	struct LineDesc
@@ -68,6 +93,68 @@ namespace Tiny2D {
 		float smoothness = 0.005f;
 	};
 
+	// Quads in the xy plane, rotated by angle (radians) around z and placed at depth layer.
+	// Uploaded as compact 2D instances, without the quaternion and the third axis of QuadDesc;
+	// angle and layer are rounded to half floats and uvs must lie in [0, 1]
+	struct Quad2DDesc
+	{
+		Math::float2 position = { 0.0f, 0.0f };
+		float angle = 0.0f;
+		Math::float2 size = { 1.0f, 1.0f };
+		float layer = 0.0f;
+		Math::float2 minUV = { 0.0f, 0.0f };
+		Math::float2 maxUV = { 1.0f, 1.0f };
+		Math::float4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+		nvrhi::ITexture* texture = nullptr;
+		uint32_t id = (uint32_t)-1;
+	};
+
+	// circles in the xy plane at depth layer, same upload path as Quad2DDesc
+	struct Circle2DDesc
+	{
+		Math::float2 position = { 0.0f, 0.0f };
+		float radius = 0.5f;
+		float layer = 0.0f;
+		Math::float4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+		float thickness = 0.02f;
+	};
+
+	// Quads from parallel arrays, one element per position. Every other span is either empty,
+	// in which case its uniform value below applies to all quads, or at least as long as positions
+	struct QuadStreams
+	{
+		std::span<const Math::float3> positions;
+		std::span<const Math::float4> colors;
+		std::span<const Math::float3> scales;
+		std::span<const Math::quat> rotations;
+
+		Math::float4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+		Math::float3 scale = { 1.0f, 1.0f, 1.0f };
+		Math::quat rotation = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+		// shared by every quad
+		Math::float2 minUV = { 0.0f, 0.0f };
+		Math::float2 maxUV = { 1.0f, 1.0f };
+		nvrhi::ITexture* texture = nullptr;
+		uint32_t id = (uint32_t)-1;
+	};
+
+	// circles from parallel arrays, same rules as QuadStreams
+	struct CircleStreams
+	{
+		std::span<const Math::float3> positions;
+		std::span<const Math::float4> colors;
+		std::span<const float> radii;
+		std::span<const Math::quat> rotations;
+
+		Math::float4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+		float radius = 0.5f;
+		Math::quat rotation = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+		// shared by every circle
+		float thickness = 0.02f;
+	};
+
 	struct WireBoxDesc
 	{
 		Math::float3 position = { 0.0f,0.0f ,0.0f };
@@ -112,6 +199,32 @@ namespace Tiny2D {
 		Math::float3 max = { 1.0f, 1.0f, 1.0f };
 		Math::float4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
 		float thickness = 1.0f;
+		uint32_t level = 0; // depth in a hierarchy, only read with an AABBColorRamp
+	};
+
+	// colors AABBs by level instead of their own color, from root at level 0 to leaf at levelCount - 1 and deeper
+	struct AABBColorRamp
+	{
+		Math::float4 root = { 1.0f, 0.0f, 0.0f, 1.0f };
+		Math::float4 leaf = { 0.0f, 0.0f, 1.0f, 1.0f };
+		uint32_t levelCount = 16;
+	};
+
+	// Wireframe of a mesh that is already in GPU buffers, read by a shader without copies. Both buffers need
+	// canHaveRawViews and a known state (keepInitialState or tracked on the command list). Positions are float3
+	// and every offset and stride is a multiple of 4 bytes
+	struct MeshWireframeDesc
+	{
+		nvrhi::IBuffer* vertexBuffer = nullptr;
+		uint32_t vertexOffset = 0;                      // bytes to the position of the first vertex
+		uint32_t vertexStride = sizeof(Math::float3);   // bytes between two positions
+		nvrhi::IBuffer* indexBuffer = nullptr;          // null draws consecutive vertices as triangles
+		nvrhi::Format indexFormat = nvrhi::Format::R32_UINT; // or R16_UINT
+		uint32_t indexOffset = 0;                       // bytes to the first index
+		uint32_t triangleCount = 0;
+		Math::float4x4 transform = Math::float4x4(1.0f);
+		Math::float4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+		float thickness = 1.0f;
 	};
 
 	struct BoxDesc
@@ -138,11 +251,55 @@ namespace Tiny2D {
 		Math::int2 viewSize = { 1920, 1080 };
 		nvrhi::Format renderTargetColorFormat = nvrhi::Format::RGBA8_UNORM;
 		uint8_t sampleCount = 4;
+
+		// number of upload buffers each pass cycles through, the command list passed to BeginScene
+		// must be submitted before the next BeginScene of the same view
+		uint32_t framesInFlight = 3;
+
+		// expected primitives per frame, the view allocates for them up front instead of growing, 0 means no hint
+		uint32_t lineCapacity = 0;
+		uint32_t spriteCapacity = 0;
+		uint32_t circleCapacity = 0;
+		uint32_t textCapacity = 0; // glyphs
+		uint32_t boxCapacity = 0;
+
+		// upload bytes the draw contexts of the view hold at once, 0 grows as needed. No upload buffer is larger than
+		// the budget and the bytes not yet consumed by the GPU never exceed it, whatever the policy. Past it overflowPolicy applies;
+		// Flush keeps one more buffer per draw context and waits for the GPU to read a flushed buffer before writing it again.
+		uint64_t memoryBudget = 0;
+		OverflowPolicy overflowPolicy = OverflowPolicy::Flush;
+
+		// called by OverflowPolicy::Flush with the command list of BeginScene after the pending draws have been recorded into it;
+		// it must close, execute and reopen the command list. Left empty, Tiny2D never submits the command list
+		std::function<void(nvrhi::ICommandList*)> submit;
+
+		// largest distance in pixels between the circles of wire cylinders and capsules and their segments,
+		// each shape takes the fewest of 4, 8, 16 or 32 segments that stays within it. 0 always uses 32
+		float wireTolerance = 0.5f;
+	};
+
+	enum class LineMode : uint8_t
+	{
+		GeometryShader, // each segment is expanded to a quad in a geometry shader
+		Instanced,      // each segment is an instance expanded in the vertex shader, for drivers with slow geometry shaders
 	};
 
-	TINY2D_API void Init(nvrhi::IDevice* device);
+	struct InitDesc
+	{
+		// sprites, circles, text and boxes upload RGBA8 colors, half-float scales, 16-bit unorm uvs and 32-bit quaternions,
+		// about half the bytes per instance; positions keep full precision
+		bool packedInstances = false;
+
+		// both produce the same pixels
+		LineMode lineMode = LineMode::GeometryShader;
+	};
+
+	TINY2D_API void Init(nvrhi::IDevice* device, const InitDesc& desc = {});
 	TINY2D_API void Shutdown();
 
+	// The active view is per thread, so different views can be recorded concurrently on their own command lists.
+	// commandList must be open; Tiny2D only records into it, never closes or executes it except through ViewDesc::submit.
+	// The caller submits it after EndScene and before the next BeginScene of the same view.
 	TINY2D_API void BeginScene(ViewHandle& viewHandle, nvrhi::ICommandList* commandList, const ViewDesc& desc);
 	TINY2D_API void EndScene();
 	TINY2D_API nvrhi::ITexture* GetColorTarget(ViewHandle viewHandle);
@@ -150,6 +307,11 @@ namespace Tiny2D {
 	TINY2D_API nvrhi::ITexture* GetEntitiesIDTarget(ViewHandle viewHandle);
 	TINY2D_API const Stats& GetStats(ViewHandle viewHandle);
 
+	// Binds a private DrawContext of the view to the calling thread, Draw* calls made on that thread go into it.
+	// Acquire after BeginScene and release before EndScene; contexts are drawn in acquisition order.
+	TINY2D_API DrawContext* AcquireDrawContext(ViewHandle viewHandle);
+	TINY2D_API void ReleaseDrawContext(DrawContext* context);
+
 	TINY2D_API void DrawLine(const LineDesc& desc);
 	TINY2D_API void DrawLineList(std::span<Math::float3> view, const Math::float4& color = { 1.0f, 1.0f, 1.0f , 1.0f }, float thickness = 1.0f);
 	TINY2D_API void DrawLineList(Math::float3* points, uint32_t size, const Math::float4& color = { 1.0f, 1.0f, 1.0f , 1.0f }, float thickness = 1.0f);
@@ -158,6 +320,18 @@ namespace Tiny2D {
 	TINY2D_API void DrawCircle(const CircleDesc& desc);
 	TINY2D_API void DrawQuad(const QuadDesc& desc);
 	TINY2D_API void DrawText(const TextDesc& desc);
+
+	// Same as one Draw* call per element, the upload memory is reserved in large chunks and filled in one loop
+	TINY2D_API void DrawLines(std::span<const LineDesc> lines);
+	TINY2D_API void DrawQuads(std::span<const QuadDesc> quads);
+	TINY2D_API void DrawCircles(std::span<const CircleDesc> circles);
+	TINY2D_API void DrawBoxes(std::span<const BoxDesc> boxes);
+	TINY2D_API void DrawQuads(const QuadStreams& streams);
+	TINY2D_API void DrawCircles(const CircleStreams& streams);
+	TINY2D_API void DrawQuad2D(const Quad2DDesc& desc);
+	TINY2D_API void DrawCircle2D(const Circle2DDesc& desc);
+	TINY2D_API void DrawQuads2D(std::span<const Quad2DDesc> quads);
+	TINY2D_API void DrawCircles2D(std::span<const Circle2DDesc> circles);
 	
 	TINY2D_API void DrawWireBox(const WireBoxDesc& desc);
 	TINY2D_API void DrawWireSphere(const WireSphereDesc& desc);
@@ -165,6 +339,21 @@ namespace Tiny2D {
 	TINY2D_API void DrawWireCapsule(const WireCapsuleDesc& desc);
 	TINY2D_API void DrawMeshWireframe(Math::float4x4 wt, const Math::float3* vertices, size_t vertexCount, const uint32_t* indices = nullptr, size_t indexCount = 0, const Math::float4& color = Math::float4(1));
 
+	// Draws every edge shared by two triangles once. The unique edges are built on the first call and cached under key,
+	// later calls only transform the vertices. Use a new key or ReleaseMeshWireframe when the indices change.
+	TINY2D_API void DrawMeshWireframe(uint64_t key, Math::float4x4 wt, const Math::float3* vertices, size_t vertexCount, const uint32_t* indices = nullptr, size_t indexCount = 0, const Math::float4& color = Math::float4(1));
+	TINY2D_API void ReleaseMeshWireframe(uint64_t key);
+	TINY2D_API void DrawMeshWireframe(const MeshWireframeDesc& desc);
+
 	TINY2D_API void DrawAABB(const AABBDesc& desc);
+	TINY2D_API void DrawAABBs(std::span<const AABBDesc> boxes);
+	TINY2D_API void DrawAABBs(std::span<const AABBDesc> boxes, const AABBColorRamp& ramp);
 	TINY2D_API void DrawBox(const BoxDesc& desc);
+
+	// Records the Draw* calls made inside record once into a GPU-resident buffer. The copies are recorded on
+	// commandList, which must be executed before the batch is first drawn.
+	TINY2D_API StaticBatchHandle CreateStaticBatch(nvrhi::ICommandList* commandList, const std::function<void()>& record);
+
+	// Draws a static batch in the current scene with transform applied before the view projection, nothing is rewritten.
+	TINY2D_API void DrawStaticBatch(StaticBatchHandle batch, const Math::float4x4& transform = Math::float4x4(1.0f));
 };
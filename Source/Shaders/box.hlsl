@@ -16,79 +16,54 @@ struct VertexOutput
     float4 color : COLOR;
 };
 
-struct Vertex
+// corner i is at (i & 1, (i >> 1) & 1, (i >> 2) & 1) - 0.5
+static const float3 s_BoxCorners[8] =
 {
-    float3 position;
-    float3 normal;
-    float2 uv;
+    float3(-0.5, -0.5, -0.5),
+    float3( 0.5, -0.5, -0.5),
+    float3(-0.5,  0.5, -0.5),
+    float3( 0.5,  0.5, -0.5),
+    float3(-0.5, -0.5,  0.5),
+    float3( 0.5, -0.5,  0.5),
+    float3(-0.5,  0.5,  0.5),
+    float3( 0.5,  0.5,  0.5)
 };
 
-static const Vertex s_BoxVertices[36] =
-{
-    // Front Face
-    { float3(-0.5, -0.5,  0.5), float3(0,  0,  1), float2(0, 1) },
-    { float3(0.5, -0.5,  0.5),  float3(0,  0,  1), float2(1, 1) },
-    { float3(0.5,  0.5,  0.5),  float3(0,  0,  1), float2(1, 0) },
-    { float3(-0.5, -0.5,  0.5), float3(0,  0,  1), float2(0, 1) },
-    { float3(0.5,  0.5,  0.5),  float3(0,  0,  1), float2(1, 0) },
-    { float3(-0.5,  0.5,  0.5), float3(0,  0,  1), float2(0, 0) },
-
-    // Back Face
-    { float3(0.5, -0.5, -0.5),  float3(0,  0, -1), float2(0, 1) },
-    { float3(-0.5, -0.5, -0.5), float3(0,  0, -1), float2(1, 1) },
-    { float3(-0.5,  0.5, -0.5), float3(0,  0, -1), float2(1, 0) },
-    { float3(0.5, -0.5, -0.5),  float3(0,  0, -1), float2(0, 1) },
-    { float3(-0.5,  0.5, -0.5), float3(0,  0, -1), float2(1, 0) },
-    { float3(0.5,  0.5, -0.5),  float3(0,  0, -1), float2(0, 0) },
-
-    // Left Face
-    { float3(-0.5, -0.5, -0.5), float3(-1,  0,  0), float2(0, 1) },
-    { float3(-0.5, -0.5,  0.5), float3(-1,  0,  0), float2(1, 1) },
-    { float3(-0.5,  0.5,  0.5), float3(-1,  0,  0), float2(1, 0) },
-    { float3(-0.5, -0.5, -0.5), float3(-1,  0,  0), float2(0, 1) },
-    { float3(-0.5,  0.5,  0.5), float3(-1,  0,  0), float2(1, 0) },
-    { float3(-0.5,  0.5, -0.5), float3(-1,  0,  0), float2(0, 0) },
+// the 12 triangles of the cube as one strip, each corner is shared by up to 6 triangles
+// and every triangle is counter clockwise seen from outside once the strip winding is applied
+static const uint s_BoxStrip[14] = { 6, 7, 2, 3, 1, 7, 5, 6, 4, 2, 0, 1, 4, 5 };
 
-    // Right Face
-    { float3(0.5, -0.5,  0.5),  float3(1,  0,  0), float2(0, 1) },
-    { float3(0.5, -0.5, -0.5),  float3(1,  0,  0), float2(1, 1) },
-    { float3(0.5,  0.5, -0.5),  float3(1,  0,  0), float2(1, 0) },
-    { float3(0.5, -0.5,  0.5),  float3(1,  0,  0), float2(0, 1) },
-    { float3(0.5,  0.5, -0.5),  float3(1,  0,  0), float2(1, 0) },
-    { float3(0.5,  0.5,  0.5),  float3(1,  0,  0), float2(0, 0) },
-
-    // Top Face
-    { float3(-0.5,  0.5,  0.5), float3(0,  1,  0), float2(0, 1) },
-    { float3(0.5,  0.5,  0.5),  float3(0,  1,  0), float2(1, 1) },
-    { float3(0.5,  0.5, -0.5),  float3(0,  1,  0), float2(1, 0) },
-    { float3(-0.5,  0.5,  0.5), float3(0,  1,  0), float2(0, 1) },
-    { float3(0.5,  0.5, -0.5),  float3(0,  1,  0), float2(1, 0) },
-    { float3(-0.5,  0.5, -0.5), float3(0,  1,  0), float2(0, 0) },
+VertexOutput BoxVertex(float3x4 world, float4 color, uint vertexID)
+{
+    VertexOutput output;
+    output.position = WorldToClip(viewParms.viewProjMatrix, world, s_BoxCorners[s_BoxStrip[vertexID]]);
+    output.color = color;
 
-    // Bottom Face
-    { float3(-0.5, -0.5, -0.5), float3(0, -1,  0), float2(0, 1) },
-    { float3(0.5, -0.5, -0.5),  float3(0, -1,  0), float2(1, 1) },
-    { float3(0.5, -0.5,  0.5),  float3(0, -1,  0), float2(1, 0) },
-    { float3(-0.5, -0.5, -0.5), float3(0, -1,  0), float2(0, 1) },
-    { float3(0.5, -0.5,  0.5),  float3(0, -1,  0), float2(1, 0) },
-    { float3(-0.5, -0.5,  0.5), float3(0, -1,  0), float2(0, 0) }
-};
+    return output;
+}
 
+// BoxAttributes
 VertexOutput main_vs(
-    in float3 position : POSITION,
-    in float4 rotation : ROTATION,
-    in float3 scale : SCALE,
+    in float4 worldX : WORLDX,
+    in float4 worldY : WORLDY,
+    in float4 worldZ : WORLDZ,
     in float4 color : COLOR,
     uint vertexID : SV_VertexID
 )
 {
-    float4x4 transform = ConstructTransformMatrix(position, rotation, scale);
-
-    VertexOutput output;
-    output.position = mul(mul(viewParms.viewProjMatrix, transform), float4(s_BoxVertices[vertexID].position, 1.0f));
-    output.color = color;
+    return BoxVertex(float3x4(worldX, worldY, worldZ), color, vertexID);
+}
 
-    return output;
+// PackedBoxAttributes
+VertexOutput main_vs_packed(
+    in float3 position : POSITION,
+    in uint   rotation : ROTATION,
+    in float4 scale : SCALE,
+    in float4 color : COLOR,
+    uint vertexID : SV_VertexID
+)
+{
+    return BoxVertex(ConstructWorldMatrix(position, UnpackQuaternion(rotation), scale.xyz), color, vertexID);
 }
 
 void main_ps(
@@ -18,40 +18,54 @@ struct VertexOutput
 	float  thickness : THICKNESS;
 };
 
-struct Vertex
+VertexOutput CircleVertex(float3x4 world, float4 color, float thickness, uint vertexID)
 {
-	float3 position;
-	float2 uv;
-};
+	float2 corner = QuadCorner(vertexID);
 
-static const Vertex s_QuadVertices[6] = {
-	{ float3(-0.5f, -0.5f, 0.0f) , float2(0.0f, 0.0f) },
-	{ float3(0.5f, -0.5f, 0.0f) , float2(1.0f, 0.0f) },
-	{ float3(0.5f,  0.5f, 0.0f) , float2(1.0f, 1.0f) },
-	{ float3(-0.5f,  0.5f, 0.0f) , float2(0.0f, 1.0f) },
-	{ float3(-0.5f, -0.5f, 0.0f) , float2(0.0f, 0.0f) },
-	{ float3(0.5f,  0.5f, 0.0f) , float2(1.0f, 1.0f) }
-};
+	VertexOutput output;
+	output.position = WorldToClip(viewParms.viewProjMatrix, world, float3(corner - 0.5f, 0.0f));
+	output.color = color;
+	output.uv = corner;
+	output.thickness = thickness;
 
+	return output;
+}
 
+// CircleAttributes, the world matrix scales the unit quad to the diameter
 VertexOutput main_vs(
+	in float4 worldX : WORLDX,
+	in float4 worldY : WORLDY,
+	in float4 worldZ : WORLDZ,
+	in float4 color : COLOR,
+	in float  thickness : THICKNESS,
+	uint vertexID : SV_VertexID
+)
+{
+	return CircleVertex(float3x4(worldX, worldY, worldZ), color, thickness, vertexID);
+}
+
+// PackedCircleAttributes
+VertexOutput main_vs_packed(
 	in float3 position : POSITION,
 	in float  radius : RADIUS,
-	in float4 rotation : ROTATION,
+	in uint   rotation : ROTATION,
 	in float4 color : COLOR,
 	in float  thickness : THICKNESS,
 	uint vertexID : SV_VertexID
 )
 {
-	float4x4 transform = ConstructTransformMatrix(position, rotation, radius * 2.0f);
-	
-	VertexOutput output;
-	output.position = mul(mul(viewParms.viewProjMatrix, transform), float4(s_QuadVertices[vertexID].position,1.0));
-	output.color = color;
-	output.uv = s_QuadVertices[vertexID].uv;
-	output.thickness = thickness;
+	return CircleVertex(ConstructWorldMatrix(position, UnpackQuaternion(rotation), radius * 2.0f), color, thickness, vertexID);
+}
 
-	return output;
+// Circle2DAttributes, transform is position.xy, radius and layer
+VertexOutput main_vs_2d(
+	in float4 transform : TRANSFORM,
+	in float4 color : COLOR,
+	in float  thickness : THICKNESS,
+	uint vertexID : SV_VertexID
+)
+{
+	return CircleVertex(ConstructWorldMatrix2D(transform.xy, 0.0f, transform.z * 2.0f, transform.w), color, thickness, vertexID);
 }
 
 void main_ps(
@@ -1,5 +1,7 @@
 ﻿#pragma pack_matrix(row_major)
 
+#include "tiny2D.h"
+
 struct ViewParms
 {
 	float4x4 viewProjMatrix;
@@ -8,11 +10,22 @@ struct ViewParms
 
 ConstantBuffer<ViewParms> viewParms : register(b0);
 
+// constant for every line of a draw
+struct LineParms
+{
+	float thickness;
+};
+
+VK_PUSH_CONSTANT ConstantBuffer<LineParms> lineParms : register(b1);
+
+// position.x bits of the vertex ending each line strip, LinePass::c_RestartBits
+static const uint c_RestartBits = 0xFFFFFFFF;
+
 struct VertexOutput
 {
     float4 position : SV_POSITION;
     float4 color : COLOR;
-    float thickness : THICKNESS;
+    uint restart : RESTART;
 };
 
 struct GeoOutput
@@ -23,15 +36,14 @@ struct GeoOutput
 
 VertexOutput main_vs(
 	in float3 position : POSITION,
-	in float4 color : COLOR,
-	in float thickness : THICKNESS
+	in float4 color : COLOR
 )
 {
     VertexOutput output;
 
 	output.position = mul(float4(position, 1), viewParms.viewProjMatrix);
 	output.color = color;
-	output.thickness = thickness;
+	output.restart = asuint(position.x) == c_RestartBits;
 
 	return output;
 }
@@ -42,22 +54,16 @@ void main_gs(
     inout TriangleStream<GeoOutput> outputStream
 )
 {
+    // the segments of a strip into and out of its restart vertex
+    if (input[0].restart || input[1].restart)
+        return;
+
     GeoOutput output[4];
 
     float4 p0 = input[0].position;
     float4 p1 = input[1].position;
 
-    float2 screenP0 = (p0.xy / p0.w) * 0.5 + 0.5;
-    screenP0 *= viewParms.viewSize.xy;
-
-    float2 screenP1 = (p1.xy / p1.w) * 0.5 + 0.5;
-    screenP1 *= viewParms.viewSize.xy;
-
-    float2 screenDir = screenP1 - screenP0;
-    float2 perpDir = normalize(float2(-screenDir.y, screenDir.x));
-
-    float2 pixelToClip = float2(2.0 / viewParms.viewSize.x, 2.0 / viewParms.viewSize.y);
-    float2 offset = perpDir * input[0].thickness * pixelToClip;
+    float2 offset = LineOffset(p0, p1, lineParms.thickness, viewParms.viewSize);
 
     output[0].position = float4(p0.xy + offset * p0.w, p0.zw);
     output[1].position = float4(p0.xy - offset * p0.w, p0.zw);
@@ -80,6 +86,33 @@ void main_gs(
     outputStream.RestartStrip();
 }
 
+// LineMode::Instanced, one instance per segment, emits the two triangles of main_gs in the same order
+GeoOutput main_vs_instanced(
+	in float3 position0 : FROM,
+	in float4 color0 : FROMCOLOR,
+	in float3 position1 : TO,
+	in float4 color1 : TOCOLOR,
+	uint vertexID : SV_VertexID
+)
+{
+    uint corner = s_LineQuadCorners[vertexID];
+
+    float4 p0 = mul(float4(position0, 1), viewParms.viewProjMatrix);
+    float4 p1 = mul(float4(position1, 1), viewParms.viewProjMatrix);
+
+    float2 offset = LineOffset(p0, p1, lineParms.thickness, viewParms.viewSize);
+
+    GeoOutput output;
+    output.position = LineCorner(p0, p1, offset, corner);
+    output.color = corner < 2 ? color0 : color1;
+
+    // collapses the segments of a strip into and out of its restart vertex
+    if (asuint(position0.x) == c_RestartBits || asuint(position1.x) == c_RestartBits)
+        output.position = 0;
+
+    return output;
+}
+
 void main_ps(
     in GeoOutput input,
     out float4 color : SV_Target0
@@ -21,24 +21,31 @@ struct VertexOutput
 	float2 uv : TEXCOORD0;
 };
 
-struct Vertex
+VertexOutput SpriteVertex(float3x4 world, float4 uv, float4 color, int textureID, uint id, uint vertexID)
 {
-	float3 position;
-};
+	float2 corner = QuadCorner(vertexID);
 
-static const Vertex s_QuadVertices[6] = {
-	{ float3( -0.5f, -0.5f, 0.0f) },
-	{ float3(  0.5f, -0.5f, 0.0f) },
-	{ float3(  0.5f,  0.5f, 0.0f) },
-	{ float3( -0.5f,  0.5f, 0.0f) },
-	{ float3( -0.5f, -0.5f, 0.0f) },
-	{ float3(  0.5f,  0.5f, 0.0f) }
-};
+	VertexOutput output;
+	output.position = WorldToClip(viewParms.viewProjMatrix, world, float3(corner - 0.5f, 0.0f));
+	output.color = color;
+	output.textureID = textureID;
+	output.id = id;
+
+	//	uv.xy		uv.zy
+	//		0-------1
+	//		|       |
+	//		2-------3
+	//	uv.xw		uv.zw
+	output.uv = lerp(uv.xy, uv.zw, corner);
 
+	return output;
+}
+
+// spriteAttributes
 VertexOutput main_vs(
-	in float3 position : POSITION,
-	in float4 rotation : ROTATION,
-	in float3 scale : SCALE,
+	in float4 worldX : WORLDX,
+	in float4 worldY : WORLDY,
+	in float4 worldZ : WORLDZ,
 	in float4 uv : UV,
 	in float4 color : COLOR,
 	in int    textureID : TEXTUREID,
@@ -46,25 +53,37 @@ VertexOutput main_vs(
 	uint      vertexID : SV_VertexID
 )
 {
-	float4x4 transform = ConstructTransformMatrix(position, rotation, scale);
-
-	VertexOutput output;
-	output.position = mul(mul(viewParms.viewProjMatrix, transform), float4(s_QuadVertices[vertexID].position, 1.0));
-	output.color = color;
-	output.textureID = textureID;
-	output.id = id;
+	return SpriteVertex(float3x4(worldX, worldY, worldZ), uv, color, textureID, id, vertexID);
+}
 
-	switch (vertexID)					   //   0, 4         1
-	{									   //	uv.xy        uv.zy
-	case 0: output.uv = uv.xy; break;	   //		x-------x
-	case 1: output.uv = uv.zy; break;	   //		|       |
-	case 2: output.uv = uv.zw; break;	   //		|       |
-	case 3: output.uv = uv.xw; break;	   //		x-------x
-	case 4: output.uv = uv.xy; break;	   //	uv.xw		uv.zw
-	case 5: output.uv = uv.zw; break;	   //	3   		2, 5
-	}
+// PackedSpriteAttributes, scale arrives as halfs, uv as RGBA16 unorm and color as RGBA8, the input assembler expands them
+VertexOutput main_vs_packed(
+	in float3 position : POSITION,
+	in uint   rotation : ROTATION,
+	in float4 scale : SCALE,
+	in float4 uv : UV,
+	in float4 color : COLOR,
+	in int    textureID : TEXTUREID,
+	in uint   id : ENTITYID,
+	uint      vertexID : SV_VertexID
+)
+{
+	return SpriteVertex(ConstructWorldMatrix(position, UnpackQuaternion(rotation), scale.xyz), uv, color, textureID, id, vertexID);
+}
 
-	return output;
+// Sprite2DAttributes, angle and layer arrive as halfs and uv as RGBA16 unorm
+VertexOutput main_vs_2d(
+	in float2 position : POSITION,
+	in float2 angleLayer : ANGLELAYER,
+	in float2 size : SCALE,
+	in float4 uv : UV,
+	in float4 color : COLOR,
+	in int    textureID : TEXTUREID,
+	in uint   id : ENTITYID,
+	uint      vertexID : SV_VertexID
+)
+{
+	return SpriteVertex(ConstructWorldMatrix2D(position, angleLayer.x, size, angleLayer.y), uv, color, textureID, id, vertexID);
 }
 
 SamplerState s_Sampler : register(s0);
@@ -12,20 +12,6 @@ ConstantBuffer<ViewParms> viewParms : register(b0);
 
 VK_BINDING(0, 1) Texture2D t_BindlessTextures[] : register(t0, space1);
 
-struct Vertex
-{
-	float3 position;
-};
-
-static const Vertex s_QuadVertices[6] = {
-	{ float3(-0.5f, -0.5f, 0.0f) },
-	{ float3(0.5f, -0.5f, 0.0f) },
-	{ float3(0.5f,  0.5f, 0.0f) },
-	{ float3(-0.5f,  0.5f, 0.0f) },
-	{ float3(-0.5f, -0.5f, 0.0f) },
-	{ float3(0.5f,  0.5f, 0.0f) }
-};
-
 struct VertexOutput
 {
 	float4 position : SV_POSITION;
@@ -34,37 +20,54 @@ struct VertexOutput
 	uint   textureID : TEXTUREID;
 };
 
-VertexOutput main_vs(
-	in float3 position : POSITION,
-	in float4 rotation : ROTATION,
-	in float3 scale : SCALE,
-	in float4 uv : UV,
-	in float4 color : COLOR,
-	in uint   textureID : TEXTUREID,
-	uint   vertexID : SV_VertexID
-)
+VertexOutput TextVertex(float3x4 world, float4 uv, float4 color, uint textureID, uint vertexID)
 {
-	float4x4 transform = ConstructTransformMatrix(position, rotation, scale);
+	float2 corner = QuadCorner(vertexID);
 
 	VertexOutput output;
 
-	output.position = mul(mul(viewParms.viewProjMatrix, transform), float4(s_QuadVertices[vertexID].position,1.0));
+	output.position = WorldToClip(viewParms.viewProjMatrix, world, float3(corner - 0.5f, 0.0f));
 	output.color = color;
 	output.textureID = textureID;
 
-	switch (vertexID)					   //   0, 4         1
-	{									   //	uv.xy        uv.zy
-	case 0: output.uv = uv.xy; break;	   //		x-------x
-	case 1: output.uv = uv.zy; break;	   //		|       |
-	case 2: output.uv = uv.zw; break;	   //		|       |
-	case 3: output.uv = uv.xw; break;	   //		x-------x
-	case 4: output.uv = uv.xy; break;	   //	uv.xw		uv.zw
-	case 5: output.uv = uv.zw; break;	   //	3   		2, 5
-	}									   
+	//	uv.xy		uv.zy
+	//		0-------1
+	//		|       |
+	//		2-------3
+	//	uv.xw		uv.zw
+	output.uv = lerp(uv.xy, uv.zw, corner);
 
 	return output;
 }
 
+// TextAttributes
+VertexOutput main_vs(
+	in float4 worldX : WORLDX,
+	in float4 worldY : WORLDY,
+	in float4 worldZ : WORLDZ,
+	in float4 uv : UV,
+	in float4 color : COLOR,
+	in uint   textureID : TEXTUREID,
+	uint   vertexID : SV_VertexID
+)
+{
+	return TextVertex(float3x4(worldX, worldY, worldZ), uv, color, textureID, vertexID);
+}
+
+// PackedTextAttributes
+VertexOutput main_vs_packed(
+	in float3 position : POSITION,
+	in uint   rotation : ROTATION,
+	in float4 scale : SCALE,
+	in float4 uv : UV,
+	in float4 color : COLOR,
+	in uint   textureID : TEXTUREID,
+	uint   vertexID : SV_VertexID
+)
+{
+	return TextVertex(ConstructWorldMatrix(position, UnpackQuaternion(rotation), scale.xyz), uv, color, textureID, vertexID);
+}
+
 SamplerState s_Sampler : register(s0);
 
 float screenPxRange(float2 uv)
@@ -39,4 +39,75 @@ float4x4 ConstructTransformMatrix(float3 position, float4 rotation, float3 scale
 	return mul(translationMatrix, mul(rotationMatrix, scaleMatrix));
 }
 
+// the world matrix uploaded with full precision instances, WorldMatrix in Tiny2D.cpp
+float3x4 ConstructWorldMatrix(float3 position, float4 rotation, float3 scale)
+{
+	return (float3x4)ConstructTransformMatrix(position, rotation, scale);
+}
+
+// corner of a quad drawn as a 4 vertex triangle strip, (0,0) (1,0) (0,1) (1,1)
+float2 QuadCorner(uint vertexID)
+{
+	return float2(vertexID & 1, vertexID >> 1);
+}
+
+// rotation by angle around z then translation to (position, layer), the xy plane of the 2D instances
+float3x4 ConstructWorldMatrix2D(float2 position, float angle, float2 scale, float layer)
+{
+	float s, c;
+	sincos(angle, s, c);
+
+	return float3x4(
+		c * scale.x, -s * scale.y, 0.0f, position.x,
+		s * scale.x,  c * scale.y, 0.0f, position.y,
+		0.0f,         0.0f,        1.0f, layer);
+}
+
+float4 WorldToClip(float4x4 viewProj, float3x4 world, float3 position)
+{
+	return mul(viewProj, float4(mul(world, float4(position, 1.0f)), 1.0f));
+}
+
+// inverse of PackQuaternion in Tiny2D.cpp, 2 bits select the largest component and the other three take 10 bits each
+float4 UnpackQuaternion(uint packed)
+{
+	float3 v = (float3(uint3(packed >> 20, packed >> 10, packed) & 1023) / 1023.0f * 2.0f - 1.0f) * 0.70710678f;
+	float w = sqrt(saturate(1.0f - dot(v, v)));
+
+	switch (packed >> 30)
+	{
+	case 0:  return float4(w, v.x, v.y, v.z);
+	case 1:  return float4(v.x, w, v.y, v.z);
+	case 2:  return float4(v.x, v.y, w, v.z);
+	default: return float4(v.x, v.y, v.z, w);
+	}
+}
+
+// Lines expanded to screen space quads, thickness in pixels.
+// Corners 0 and 1 lie at p0, 2 and 3 at p1, s_LineQuadCorners orders the 6 vertices of the quad like main_gs of line.hlsl.
+static const uint s_LineQuadCorners[6] = { 0, 1, 2, 2, 1, 3 };
+
+float2 LineOffset(float4 p0, float4 p1, float thickness, float2 viewSize)
+{
+	float2 screenP0 = (p0.xy / p0.w) * 0.5 + 0.5;
+	screenP0 *= viewSize.xy;
+
+	float2 screenP1 = (p1.xy / p1.w) * 0.5 + 0.5;
+	screenP1 *= viewSize.xy;
+
+	float2 screenDir = screenP1 - screenP0;
+	float2 perpDir = normalize(float2(-screenDir.y, screenDir.x));
+
+	float2 pixelToClip = float2(2.0 / viewSize.x, 2.0 / viewSize.y);
+	return perpDir * thickness * pixelToClip;
+}
+
+float4 LineCorner(float4 p0, float4 p1, float2 offset, uint corner)
+{
+	float4 p = corner < 2 ? p0 : p1;
+	float side = (corner & 1) ? -1.0 : 1.0;
+
+	return float4(p.xy + side * offset * p.w, p.zw);
+}
+
 #endif // HEADER_TINY2D_H
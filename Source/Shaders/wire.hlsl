@@ -0,0 +1,221 @@
+#include "tiny2D.h"
+
+//#pragma pack_matrix(row_major)
+
+struct ViewParms
+{
+    float4x4 viewProjMatrix;
+    float2 viewSize;
+};
+
+ConstantBuffer<ViewParms> viewParms : register(b0);
+
+// MeshWireframeConstants in Tiny2D.cpp, for main_vs_mesh
+struct MeshParms
+{
+    float4x4 transform;
+    float4 color;
+    uint vertexOffset;
+    uint vertexStride;
+    uint indexOffset;
+    uint indexSize; // bytes per index, 0 draws consecutive vertices
+    float thickness;
+};
+
+// the mesh bindings are a second set, ViewParms comes with the set shared by the other passes
+VK_PUSH_CONSTANT ConstantBuffer<MeshParms> meshParms : register(b1, space1);
+
+VK_BINDING(0, 1) ByteAddressBuffer t_Vertices : register(t0, space1);
+VK_BINDING(1, 1) ByteAddressBuffer t_Indices : register(t1, space1);
+
+struct VertexOutput
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+};
+
+// WireShape in Tiny2D.cpp
+static const uint c_ShapeBox = 0;
+static const uint c_ShapeCylinder = 1;
+static const uint c_ShapeCapsule = 2;
+
+static const float3 s_BoxCorners[8] =
+{
+    float3(-0.5, -0.5, -0.5),
+    float3( 0.5, -0.5, -0.5),
+    float3( 0.5, -0.5,  0.5),
+    float3(-0.5, -0.5,  0.5),
+    float3(-0.5,  0.5, -0.5),
+    float3( 0.5,  0.5, -0.5),
+    float3( 0.5,  0.5,  0.5),
+    float3(-0.5,  0.5,  0.5)
+};
+
+static const uint2 s_BoxEdges[12] =
+{
+    // top
+    uint2(4, 5), uint2(5, 6), uint2(6, 7), uint2(7, 4),
+    // bottom
+    uint2(0, 1), uint2(1, 2), uint2(2, 3), uint2(3, 0),
+    // vertical
+    uint2(0, 4), uint2(1, 5), uint2(2, 6), uint2(3, 7)
+};
+
+float3 ArcPoint(float3 center, float3 tangent, float3 bitangent, float radius, uint segments, uint index)
+{
+    float angle = index * (6.28318530718 / segments);
+    return center + (cos(angle) * tangent + sin(angle) * bitangent) * radius;
+}
+
+// endpoints in object space, the box is scaled by the transform and the round shapes by their radius and height
+// cylinder : 4 vertical edges then the top and bottom circles
+// capsule  : the cylinder edges then the half circles of the two caps in the xy and zy planes
+// every full circle is made of segments, WirePass::CircleSegments of the level the instance was drawn at
+void ShapeSegment(uint shape, uint segment, uint segments, float radius, float halfHeight, out float3 a, out float3 b)
+{
+    if (shape == c_ShapeBox)
+    {
+        a = s_BoxCorners[s_BoxEdges[segment].x];
+        b = s_BoxCorners[s_BoxEdges[segment].y];
+        return;
+    }
+
+    float3 up = float3(0, halfHeight, 0);
+
+    if (segment < 4)
+    {
+        float angle = segment * 1.57079632679;
+        float3 side = float3(cos(angle), 0, sin(angle)) * radius;
+        a = side + up;
+        b = side - up;
+        return;
+    }
+
+    segment -= 4;
+
+    if (segment < 2 * segments)
+    {
+        float3 center = segment < segments ? up : -up;
+        uint index = segment % segments;
+        a = ArcPoint(center, float3(1, 0, 0), float3(0, 0, 1), radius, segments, index);
+        b = ArcPoint(center, float3(1, 0, 0), float3(0, 0, 1), radius, segments, index + 1);
+        return;
+    }
+
+    segment -= 2 * segments;
+
+    // the upper half of each circle is centered on the top cap, the lower half on the bottom one
+    float3 axis = segment < segments ? float3(1, 0, 0) : float3(0, 0, 1);
+    uint index = segment % segments;
+    float3 center = index < segments / 2 ? up : -up;
+    a = ArcPoint(center, axis, float3(0, 1, 0), radius, segments, index);
+    b = ArcPoint(center, axis, float3(0, 1, 0), radius, segments, index + 1);
+}
+
+// WireShapeAttributes, 6 vertices per segment expanded like the instanced lines of line.hlsl
+VertexOutput main_vs(
+    in float3 position : POSITION,
+    in float4 rotation : ROTATION,
+    in float3 scale : SCALE,
+    in float4 color : COLOR,
+    in float thickness : THICKNESS,
+    in uint shape : SHAPE,
+    in uint segments : SEGMENTS,
+    uint vertexID : SV_VertexID
+)
+{
+    float3 a, b;
+    ShapeSegment(shape, vertexID / 6, segments, scale.x, scale.y * 0.5, a, b);
+
+    float4x4 transform = ConstructTransformMatrix(position, rotation, shape == c_ShapeBox ? scale : 1.0);
+    float4x4 viewProjTransform = mul(viewParms.viewProjMatrix, transform);
+
+    float4 p0 = mul(viewProjTransform, float4(a, 1.0));
+    float4 p1 = mul(viewProjTransform, float4(b, 1.0));
+
+    float2 offset = LineOffset(p0, p1, thickness, viewParms.viewSize);
+
+    VertexOutput output;
+    output.position = LineCorner(p0, p1, offset, s_LineQuadCorners[vertexID % 6]);
+    output.color = color;
+
+    return output;
+}
+
+// AABBAttributes, the 12 edges of the box between min and max
+VertexOutput main_vs_aabb(
+    in float3 boxMin : MIN,
+    in float3 boxMax : MAX,
+    in float4 color : COLOR,
+    in float thickness : THICKNESS,
+    uint vertexID : SV_VertexID
+)
+{
+    uint2 edge = s_BoxEdges[vertexID / 6];
+    float3 a = lerp(boxMin, boxMax, s_BoxCorners[edge.x] + 0.5);
+    float3 b = lerp(boxMin, boxMax, s_BoxCorners[edge.y] + 0.5);
+
+    float4 p0 = mul(viewParms.viewProjMatrix, float4(a, 1.0));
+    float4 p1 = mul(viewParms.viewProjMatrix, float4(b, 1.0));
+
+    float2 offset = LineOffset(p0, p1, thickness, viewParms.viewSize);
+
+    VertexOutput output;
+    output.position = LineCorner(p0, p1, offset, s_LineQuadCorners[vertexID % 6]);
+    output.color = color;
+
+    return output;
+}
+
+uint LoadIndex(uint i)
+{
+    if (meshParms.indexSize == 0)
+        return i;
+
+    if (meshParms.indexSize == 2)
+    {
+        uint address = meshParms.indexOffset + i * 2;
+        uint word = t_Indices.Load(address & ~3u);
+        return (address & 2) ? word >> 16 : word & 0xFFFF;
+    }
+
+    return t_Indices.Load(meshParms.indexOffset + i * 4);
+}
+
+float3 LoadPosition(uint index)
+{
+    return asfloat(t_Vertices.Load3(meshParms.vertexOffset + index * meshParms.vertexStride));
+}
+
+// 18 vertices per triangle, 6 for each of its edges; edges shared by two triangles are drawn twice
+VertexOutput main_vs_mesh(
+    uint vertexID : SV_VertexID
+)
+{
+    uint triangle = vertexID / 18;
+    uint edge = (vertexID / 6) % 3;
+
+    float3 a = LoadPosition(LoadIndex(triangle * 3 + edge));
+    float3 b = LoadPosition(LoadIndex(triangle * 3 + (edge + 1) % 3));
+
+    float4x4 viewProjTransform = mul(viewParms.viewProjMatrix, meshParms.transform);
+
+    float4 p0 = mul(viewProjTransform, float4(a, 1.0));
+    float4 p1 = mul(viewProjTransform, float4(b, 1.0));
+
+    float2 offset = LineOffset(p0, p1, meshParms.thickness, viewParms.viewSize);
+
+    VertexOutput output;
+    output.position = LineCorner(p0, p1, offset, s_LineQuadCorners[vertexID % 6]);
+    output.color = meshParms.color;
+
+    return output;
+}
+
+void main_ps(
+    in VertexOutput input,
+    out float4 color : SV_Target0
+)
+{
+    color = input.color;
+}
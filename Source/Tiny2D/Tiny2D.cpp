@@ -2,6 +2,12 @@
 #undef NVRHI_HAS_D3D11
 #include <Core/Core.h>
 #undef INFINITE
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <shared_mutex>
+#include <glm/gtc/packing.hpp>
 #include "msdf-atlas-gen.h"
 
 #include "Embeded/fonts/OpenSans-Regular.h"
@@ -11,18 +17,30 @@
 #include "Embeded/dxil/line_main_vs.bin.h"
 #include "Embeded/dxil/line_main_ps.bin.h"
 #include "Embeded/dxil/line_main_gs.bin.h"
+#include "Embeded/dxil/line_main_vs_instanced.bin.h"
 
 #include "Embeded/dxil/sprite_main_vs.bin.h"
+#include "Embeded/dxil/sprite_main_vs_packed.bin.h"
+#include "Embeded/dxil/sprite_main_vs_2d.bin.h"
 #include "Embeded/dxil/sprite_main_ps.bin.h"
 
 #include "Embeded/dxil/circle_main_vs.bin.h"
+#include "Embeded/dxil/circle_main_vs_packed.bin.h"
+#include "Embeded/dxil/circle_main_vs_2d.bin.h"
 #include "Embeded/dxil/circle_main_ps.bin.h"
 
 #include "Embeded/dxil/text_main_ps.bin.h"
 #include "Embeded/dxil/text_main_vs.bin.h"
+#include "Embeded/dxil/text_main_vs_packed.bin.h"
 
 #include "Embeded/dxil/box_main_ps.bin.h"
 #include "Embeded/dxil/box_main_vs.bin.h"
+#include "Embeded/dxil/box_main_vs_packed.bin.h"
+
+#include "Embeded/dxil/wire_main_ps.bin.h"
+#include "Embeded/dxil/wire_main_vs.bin.h"
+#include "Embeded/dxil/wire_main_vs_aabb.bin.h"
+#include "Embeded/dxil/wire_main_vs_mesh.bin.h"
 
 #endif
 
@@ -31,18 +49,30 @@
 #include "Embeded/spirv/line_main_vs.bin.h"
 #include "Embeded/spirv/line_main_ps.bin.h"
 #include "Embeded/spirv/line_main_gs.bin.h"
+#include "Embeded/spirv/line_main_vs_instanced.bin.h"
 
 #include "Embeded/spirv/sprite_main_vs.bin.h"
+#include "Embeded/spirv/sprite_main_vs_packed.bin.h"
+#include "Embeded/spirv/sprite_main_vs_2d.bin.h"
 #include "Embeded/spirv/sprite_main_ps.bin.h"
 
 #include "Embeded/spirv/circle_main_vs.bin.h"
+#include "Embeded/spirv/circle_main_vs_packed.bin.h"
+#include "Embeded/spirv/circle_main_vs_2d.bin.h"
 #include "Embeded/spirv/circle_main_ps.bin.h"
 
 #include "Embeded/spirv/text_main_ps.bin.h"
 #include "Embeded/spirv/text_main_vs.bin.h"
+#include "Embeded/spirv/text_main_vs_packed.bin.h"
 
 #include "Embeded/spirv/box_main_ps.bin.h"
 #include "Embeded/spirv/box_main_vs.bin.h"
+#include "Embeded/spirv/box_main_vs_packed.bin.h"
+
+#include "Embeded/spirv/wire_main_ps.bin.h"
+#include "Embeded/spirv/wire_main_vs.bin.h"
+#include "Embeded/spirv/wire_main_vs_aabb.bin.h"
+#include "Embeded/spirv/wire_main_vs_mesh.bin.h"
 
 #endif
 
@@ -67,18 +97,25 @@ struct DescriptorTableManager
 {
 	nvrhi::DescriptorTableHandle descriptorTable;
 
-	void Init(nvrhi::IDevice* device, nvrhi::IBindingLayout* layout)
+	// capacity is allocated up front, so views recording on other threads never see the table resized under them
+	void Init(nvrhi::IDevice* device, nvrhi::IBindingLayout* layout, uint32_t capacity)
 	{
 		m_Device = device;
 
 		descriptorTable = m_Device->createDescriptorTable(layout);
+		m_Device->resizeDescriptorTable(descriptorTable, capacity, false);
 
-		size_t capacity = descriptorTable->getCapacity();
 		m_AllocatedDescriptors.resize(capacity);
 		m_Descriptors.resize(capacity);
 		std::memset(m_Descriptors.data(), 0, sizeof(nvrhi::BindingSetItem) * capacity);
 	}
 
+	// held while binding the table, a CreateDescriptor that outgrows the capacity waits for it before resizing
+	std::shared_lock<std::shared_mutex> LockShared()
+	{
+		return std::shared_lock<std::shared_mutex>(m_Mutex);
+	}
+
 	~DescriptorTableManager()
 	{
 		for (auto& descriptor : m_Descriptors)
@@ -93,6 +130,17 @@ struct DescriptorTableManager
 
 	DescriptorIndex CreateDescriptor(nvrhi::BindingSetItem item)
 	{
+		{
+			std::shared_lock<std::shared_mutex> lock(m_Mutex);
+
+			const auto& found = m_DescriptorIndexMap.find(item);
+			if (found != m_DescriptorIndexMap.end())
+				return found->second;
+		}
+
+		std::unique_lock<std::shared_mutex> lock(m_Mutex);
+
+		// another thread may have created it between the two locks
 		const auto& found = m_DescriptorIndexMap.find(item);
 		if (found != m_DescriptorIndexMap.end())
 			return found->second;
@@ -138,6 +186,8 @@ struct DescriptorTableManager
 
 	void ReleaseDescriptor(DescriptorIndex index)
 	{
+		std::unique_lock<std::shared_mutex> lock(m_Mutex);
+
 		nvrhi::BindingSetItem& descriptor = m_Descriptors[index];
 
 		if (descriptor.resourceHandle)
@@ -190,7 +240,89 @@ private:
 	std::unordered_map<nvrhi::BindingSetItem, DescriptorIndex, BindingSetItemHasher, BindingSetItemsEqual> m_DescriptorIndexMap;
 	std::vector<bool> m_AllocatedDescriptors;
 	int m_SearchStart = 0;
+	std::shared_mutex m_Mutex;
+
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Deferred Release
+//////////////////////////////////////////////////////////////////////////
+
+// Keeps resources replaced during a frame alive until the fence of that frame has completed
+struct DeferredReleaseQueue
+{
+	void Retire(nvrhi::IResource* resource)
+	{
+		if (!resource)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Pending.push_back({ m_Frame, resource });
+	}
+
+	// the buffer stays mapped until it is released, pointers into the mapping remain writable until then
+	void RetireMapped(nvrhi::IDevice* device, nvrhi::IBuffer* buffer)
+	{
+		if (!buffer)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Pending.push_back({ m_Frame, buffer, device });
+	}
+
+	~DeferredReleaseQueue()
+	{
+		for (const Entry& entry : m_Pending)
+			Unmap(entry);
+	}
+
+	void BeginFrame(uint64_t frame, uint64_t completedFrame)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
 
+		m_Frame = frame;
+		std::erase_if(m_Pending, [completedFrame](const Entry& entry) {
+			if (entry.frame > completedFrame)
+				return false;
+
+			Unmap(entry);
+			return true;
+		});
+	}
+
+	// hands everything over to a queue that is fenced, as of its current frame
+	void MoveTo(DeferredReleaseQueue& other)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (const Entry& entry : m_Pending)
+		{
+			if (entry.mappedBy)
+				other.RetireMapped(entry.mappedBy, static_cast<nvrhi::IBuffer*>(entry.resource.Get()));
+			else
+				other.Retire(entry.resource);
+		}
+
+		m_Pending.clear();
+	}
+
+private:
+	struct Entry
+	{
+		uint64_t frame;
+		nvrhi::ResourceHandle resource;
+		nvrhi::IDevice* mappedBy = nullptr;
+	};
+
+	static void Unmap(const Entry& entry)
+	{
+		if (entry.mappedBy)
+			entry.mappedBy->unmapBuffer(static_cast<nvrhi::IBuffer*>(entry.resource.Get()));
+	}
+
+	std::mutex m_Mutex;
+	std::vector<Entry> m_Pending;
+	uint64_t m_Frame = 0;
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -217,6 +349,17 @@ struct Framebuffer
 		framebufferHandle.Reset();
 	}
 
+	void Retire(DeferredReleaseQueue& queue)
+	{
+		queue.Retire(framebufferHandle);
+		queue.Retire(color);
+		queue.Retire(resolvedColor);
+		queue.Retire(depth);
+		queue.Retire(entitiesID);
+
+		Reset();
+	}
+
 	void Init(nvrhi::IDevice* device, Math::int2 size, nvrhi::Format colorFormat, uint32_t sampleCount)
 	{
 		Reset();
@@ -430,387 +573,1341 @@ Ref<Font> LoadFontFromMemory(nvrhi::IDevice* device, nvrhi::ICommandList* comman
 }
 
 //////////////////////////////////////////////////////////////////////////
-// Line Pass
+// Upload Region
 //////////////////////////////////////////////////////////////////////////
 
-struct LinePass
+struct UploadRegion
 {
-	struct LineVertex
+	nvrhi::BufferHandle buffer;
+	uint8_t* mapped = nullptr;
+	uint64_t byteSize = 0;
+
+	void Create(nvrhi::IDevice* device, uint64_t size, const char* debugName)
 	{
-		Math::float3 position;
-		Math::float4 color;
-		float thickness;
-	};
+		nvrhi::BufferDesc desc;
+		desc.byteSize = size;
+		desc.isVertexBuffer = true;
+		desc.debugName = debugName;
+		desc.initialState = nvrhi::ResourceStates::CopyDest;
+		desc.cpuAccess = nvrhi::CpuAccessMode::Write;
 
-	nvrhi::IDevice* device;
-	nvrhi::BufferHandle vertexBuffer;
-	nvrhi::InputLayoutHandle inputLayout;
-	nvrhi::GraphicsPipelineHandle pso;
+		buffer = device->createBuffer(desc);
+		CORE_ASSERT(buffer);
 
-	LineVertex* vertexBufferBase = nullptr;
-	LineVertex* vertexBufferPtr = nullptr;
-	uint32_t maxLinesCount = 1024;
-	uint32_t vertexCount = 0;
+		mapped = (uint8_t*)device->mapBuffer(buffer, nvrhi::CpuAccessMode::Write);
+		CORE_ASSERT(mapped);
 
-	void Init(nvrhi::IDevice* pDevice, nvrhi::IShader* vertexShader)
-	{
-		device = pDevice;
+		byteSize = size;
+	}
 
-		// vertex input
-		{
-			nvrhi::VertexAttributeDesc attributes[] = {
-				{ "POSITION",   nvrhi::Format::RGB32_FLOAT,  1, 0, offsetof(LineVertex, position) , sizeof(LineVertex), false },
-				{ "COLOR",      nvrhi::Format::RGBA32_FLOAT, 1, 1, offsetof(LineVertex, color)    , sizeof(LineVertex), false },
-				{ "THICKNESS",  nvrhi::Format::R32_FLOAT,    1, 2, offsetof(LineVertex, thickness), sizeof(LineVertex), false },
-			};
-			inputLayout = device->createInputLayout(attributes, uint32_t(std::size(attributes)), vertexShader);
-		}
+	void Release(nvrhi::IDevice* device)
+	{
+		if (buffer)
+			device->unmapBuffer(buffer);
 
-		nvrhi::BufferDesc vertexBufferDesc;
-		vertexBufferDesc.byteSize = sizeof(LineVertex) * maxLinesCount * 2;
-		vertexBufferDesc.isVertexBuffer = true;
-		vertexBufferDesc.debugName = "Line-VertexBuffer";
-		vertexBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
-		vertexBufferDesc.cpuAccess = nvrhi::CpuAccessMode::Write;
-		vertexBuffer = device->createBuffer(vertexBufferDesc);
-		vertexBufferBase = (LineVertex*)device->mapBuffer(vertexBuffer, nvrhi::CpuAccessMode::Write);
+		buffer = nullptr;
+		mapped = nullptr;
+		byteSize = 0;
 	}
 
-	void ResizeBuffer(uint32_t size = 0)
+	// for regions replaced mid-frame, the GPU may still read the buffer until the frame fence completes
+	// and the streams of the arena may still write the rest of their block, so it stays mapped until then
+	void Retire(nvrhi::IDevice* device, DeferredReleaseQueue& queue)
 	{
-		auto prevMaxLinesCount = maxLinesCount;
-
-		maxLinesCount = size ? size : maxLinesCount * 2;
+		queue.RetireMapped(device, buffer);
 
-		LOG_INFO("resize MaxLinesCount LinePass {} -> {}", prevMaxLinesCount, maxLinesCount);
+		buffer = nullptr;
+		mapped = nullptr;
+		byteSize = 0;
+	}
+};
 
-		nvrhi::BufferDesc vertexBufferDesc;
-		vertexBufferDesc.byteSize = sizeof(LineVertex) * maxLinesCount * 2;
-		vertexBufferDesc.isVertexBuffer = true;
-		vertexBufferDesc.debugName = "Line-VertexBuffer";
-		vertexBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
-		vertexBufferDesc.cpuAccess = nvrhi::CpuAccessMode::Write;
+//////////////////////////////////////////////////////////////////////////
+// Arena
+//////////////////////////////////////////////////////////////////////////
 
-		auto newVertexBuffer = device->createBuffer(vertexBufferDesc);
-		auto newMappedBuffer = (LineVertex*)device->mapBuffer(newVertexBuffer, nvrhi::CpuAccessMode::Write);
+// View-wide ceiling on the upload bytes written per frame, shared by the arenas of every draw context
+struct MemoryBudget
+{
+	uint64_t limit = 0;
+	Tiny2D::OverflowPolicy policy = Tiny2D::OverflowPolicy::Flush;
+	std::atomic<uint64_t> used = 0;
 
-		CORE_ASSERT(newMappedBuffer);
+	bool Charge(uint64_t bytes)
+	{
+		if (!limit)
+			return true;
 
-		std::memcpy(newMappedBuffer, vertexBufferBase, vertexCount);
-		device->unmapBuffer(vertexBuffer);
+		uint64_t current = used.load(std::memory_order_relaxed);
+		do
+		{
+			if (current + bytes > limit)
+				return false;
+		} while (!used.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
 
-		vertexBufferBase = newMappedBuffer;
-		vertexBufferPtr = vertexBufferBase + vertexCount;
-		vertexBuffer = newVertexBuffer;
+		return true;
 	}
 
-	~LinePass()
+	void Refund(uint64_t bytes)
 	{
-		device->unmapBuffer(vertexBuffer);
+		if (limit)
+			used.fetch_sub(bytes, std::memory_order_relaxed);
 	}
+};
 
-	void Begin()
-	{
-		vertexBufferPtr = vertexBufferBase;
-		vertexCount = 0;
-	}
+// applies the overflow policy of the view to a draw context, true if its arena has been rewound
+static bool OverflowDrawContext(Tiny2D::DrawContext* context);
 
-	void End(
-		nvrhi::ICommandList* commandList, 
-		nvrhi::IBindingLayout* viewBindingLayout, 
-		nvrhi::IBindingSet* viewBindingSets,
-		nvrhi::IFramebuffer* framebuffer,
-		nvrhi::IShader* vs,
-		nvrhi::IShader* ps,
-		nvrhi::IShader* gs
-	)
+// One mapped upload buffer per frame in flight that all passes of a draw context sub-allocate from.
+// Running out of space moves on to a larger buffer, ranges handed out before stay valid until the frame fence completes.
+// Past the budget of the view the overflow policy applies, an empty range means the allocation was refused.
+struct Arena
+{
+	struct Range
 	{
-		CORE_PROFILE_SCOPE_NC("Tiny2D::LinesPass::End", RENDERING_COLOR);
-
-		CORE_ASSERT(commandList);
-		CORE_ASSERT(framebuffer);
+		nvrhi::IBuffer* buffer = nullptr;
+		uint64_t offset = 0;
+		uint8_t* data = nullptr;
+	};
 
-		Timer t;
+	static constexpr uint64_t c_Alignment = 16;
+	static constexpr uint64_t c_MinByteSize = 64 * 1024;
 
-		CORE_VERIFY(vertexCount <= maxLinesCount * 2);
+	nvrhi::IDevice* device = nullptr;
+	DeferredReleaseQueue* releaseQueue = nullptr;
+	Tiny2D::DrawContext* owner = nullptr;
+	MemoryBudget* budget = nullptr;
+	uint64_t chargedBytes = 0;
 
-		if (vertexCount <= 0)
-			return;
+	std::vector<UploadRegion> regions;
+	UploadRegion* region = nullptr;
 
-		if (!pso)
-		{
-			nvrhi::GraphicsPipelineDesc psoDesc;
-			psoDesc.VS = vs;
-			psoDesc.PS = ps;
-			psoDesc.GS = gs;
-			psoDesc.inputLayout = inputLayout;
-			psoDesc.bindingLayouts = { viewBindingLayout };
-			psoDesc.primType = nvrhi::PrimitiveType::LineList;
-			psoDesc.renderState = {
-				.blendState = {
-					.alphaToCoverageEnable = true,
-				},
-				.depthStencilState = {
-					.depthTestEnable = true
-				},
-				.rasterState = {
-					.cullMode = nvrhi::RasterCullMode::None,
-					.frontCounterClockwise = true,
-					.multisampleEnable = true,
-					.antialiasedLineEnable = true,
-				},
-			};
+	// a flush submits the region it filled and swaps it with this one, the GPU reads one while the other is written
+	UploadRegion flushRegion;
+	nvrhi::EventQueryHandle flushFence;
+	bool flushPending = false;
+	uint64_t flushChargedBytes = 0; // held against the budget until flushFence has been waited on
 
-			pso = device->createGraphicsPipeline(psoDesc, framebuffer);
-			CORE_ASSERT(pso);
-		}
+	uint64_t offset = 0;
+	uint64_t usedBytes = 0;
+	uint64_t byteSize = c_MinByteSize;
+	uint64_t peakBytes = 0;
+	uint32_t reallocations = 0;
 
-		nvrhi::GraphicsState state;
-		state.pipeline = pso;
-		state.framebuffer = framebuffer;
-		state.viewport.addViewportAndScissorRect(framebuffer->getFramebufferInfo().getViewport());
+	// over the frame, see Stats
+	uint32_t flushCount = 0;
+	uint64_t flushBytes = 0;
+	uint32_t flushFallbacks = 0;
 
-		commandList->beginMarker("Lines");
-		{
-			state.bindings = { viewBindingSets };
-			state.vertexBuffers = {
-				{ vertexBuffer, 0, 0 },
-				{ vertexBuffer, 1, 0 },
-				{ vertexBuffer, 2, 0 },
-			};
-			commandList->setGraphicsState(state);
+	void Init(nvrhi::IDevice* pDevice, DeferredReleaseQueue* pReleaseQueue, MemoryBudget* pBudget, Tiny2D::DrawContext* pOwner, uint32_t framesInFlight)
+	{
+		device = pDevice;
+		releaseQueue = pReleaseQueue;
+		budget = pBudget;
+		owner = pOwner;
 
-			commandList->draw({ .vertexCount = uint32_t(vertexCount) });
-		}
-		commandList->endMarker();
+		SetFramesInFlight(framesInFlight);
 	}
-};
 
-//////////////////////////////////////////////////////////////////////////
-//  Mesh instancing
-//////////////////////////////////////////////////////////////////////////
+	void SetFramesInFlight(uint32_t framesInFlight)
+	{
+		for (auto& r : regions)
+			r.Release(device);
 
-struct spriteAttributes
-{
-	Math::float3 position;
-	Math::quat rotation;
-	Math::float3 scale;
-	glm::vec4 uv;
-	Math::float4 color;
-	uint32_t textureID;
-	uint32_t id;
+		flushRegion.Release(device);
+		flushPending = false;
 
-	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+		regions.clear();
+		regions.resize(framesInFlight);
+		region = nullptr;
+	}
+
+	~Arena()
 	{
-		static nvrhi::VertexAttributeDesc attributes[] = {
-			{ "POSITION",  nvrhi::Format::RGB32_FLOAT,	1, 0, offsetof(spriteAttributes, position),	 sizeof(spriteAttributes), true },
-			{ "ROTATION",  nvrhi::Format::RGBA32_FLOAT,	1, 1, offsetof(spriteAttributes, rotation),	 sizeof(spriteAttributes), true },
-			{ "SCALE",	   nvrhi::Format::RGB32_FLOAT,	1, 2, offsetof(spriteAttributes, scale),	 sizeof(spriteAttributes), true },
-			{ "UV",		   nvrhi::Format::RGBA32_FLOAT,	1, 3, offsetof(spriteAttributes, uv),		 sizeof(spriteAttributes), true },
-			{ "COLOR",     nvrhi::Format::RGBA32_FLOAT,	1, 4, offsetof(spriteAttributes, color),	 sizeof(spriteAttributes), true },
-			{ "TEXTUREID", nvrhi::Format::R32_SINT,		1, 5, offsetof(spriteAttributes, textureID), sizeof(spriteAttributes), true },
-			{ "ENTITYID",  nvrhi::Format::R32_SINT,		1, 6, offsetof(spriteAttributes, id)       , sizeof(spriteAttributes), true },
-		};
+		for (auto& r : regions)
+			r.Release(device);
 
-		return attributes;
+		flushRegion.Release(device);
 	}
 
-	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::BufferHandle instanceBuffer)
+	static uint64_t Align(uint64_t size)
 	{
-		return {
-			{ instanceBuffer, 0, 0 },
-			{ instanceBuffer, 1, 0 },
-			{ instanceBuffer, 2, 0 },
-			{ instanceBuffer, 3, 0 },
-			{ instanceBuffer, 4, 0 },
-			{ instanceBuffer, 5, 0 },
-			{ instanceBuffer, 6, 0 }
-		};
+		return (size + c_Alignment - 1) & ~(c_Alignment - 1);
 	}
-};
-
-struct CircleAttributes
-{
-	Math::float3 position;
-	float radius;
-	Math::quat rotation;
-	Math::float4 color;
-	float thickness;
 
-	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	uint64_t AllocatedBytes() const
 	{
-		static nvrhi::VertexAttributeDesc attributes[] = {
-			{ "POSITION",	 nvrhi::Format::RGB32_FLOAT,   1, 0, offsetof(CircleAttributes, position),	sizeof(CircleAttributes), true },
-			{ "RADIUS",		 nvrhi::Format::R32_FLOAT,     1, 1, offsetof(CircleAttributes, radius),	sizeof(CircleAttributes), true },
-			{ "ROTATION",	 nvrhi::Format::RGBA32_FLOAT,  1, 2, offsetof(CircleAttributes, rotation),	sizeof(CircleAttributes), true },
-			{ "COLOR",       nvrhi::Format::RGBA32_FLOAT,  1, 3, offsetof(CircleAttributes, color),		sizeof(CircleAttributes), true },
-			{ "THICKNESS",   nvrhi::Format::R32_FLOAT,     1, 4, offsetof(CircleAttributes, thickness), sizeof(CircleAttributes), true },
-		};
-
+		uint64_t bytes = 0;
+		for (const auto& r : regions)
+			bytes += r.byteSize;
 
-		return attributes;
+		return bytes + flushRegion.byteSize;
 	}
 
-	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::BufferHandle instanceBuffer)
+	// expectedBytes is what the passes predict for this frame
+	void Begin(uint32_t frameIndex, uint64_t expectedBytes)
 	{
-		return {
-			{ instanceBuffer, 0, 0 },
-			{ instanceBuffer, 1, 0 },
-			{ instanceBuffer, 2, 0 },
-			{ instanceBuffer, 3, 0 },
-			{ instanceBuffer, 4, 0 },
-		};
-	}
-};
+		peakBytes = Math::max(peakBytes, usedBytes);
 
-struct TextAttributes
-{
-	Math::float3 position;
-	Math::quat rotation;
-	Math::float3 scale;
-	glm::vec4 uv;
-	glm::vec4 color;
-	uint32_t textureID;
+		uint64_t targetBytes = Math::max(c_MinByteSize, expectedBytes + expectedBytes / 4);
+		if (byteSize < targetBytes || byteSize > targetBytes * 2)
+			byteSize = targetBytes;
 
-	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
-	{
-		static nvrhi::VertexAttributeDesc attributes[] = {
-			{ "POSITION",  nvrhi::Format::RGB32_FLOAT,   1, 0, offsetof(TextAttributes, position),  sizeof(TextAttributes), true },
-			{ "ROTATION",  nvrhi::Format::RGBA32_FLOAT,	 1, 1, offsetof(TextAttributes, rotation),  sizeof(TextAttributes), true },
-			{ "SCALE",	   nvrhi::Format::RGB32_FLOAT,	 1, 2, offsetof(TextAttributes, scale),	    sizeof(TextAttributes), true },
-			{ "UV",		   nvrhi::Format::RGBA32_FLOAT,  1, 3, offsetof(TextAttributes, uv),		sizeof(TextAttributes), true },
-			{ "COLOR",     nvrhi::Format::RGBA32_FLOAT,  1, 4, offsetof(TextAttributes, color),	    sizeof(TextAttributes), true },
-			{ "TEXTUREID", nvrhi::Format::R32_UINT,      1, 5, offsetof(TextAttributes, textureID), sizeof(TextAttributes), true },
-		};
+		// no single buffer is larger than the whole budget
+		if (budget->limit)
+			byteSize = Math::min(byteSize, MaxByteSize());
 
-		return attributes;
-	}
+		// the fence of this frame slot has been waited on, its region is free to rewrite or replace
+		region = &regions[frameIndex];
 
-	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::BufferHandle instanceBuffer)
-	{
-		return {
-			{ instanceBuffer, 0, 0 },
-			{ instanceBuffer, 1, 0 },
-			{ instanceBuffer, 2, 0 },
-			{ instanceBuffer, 3, 0 },
-			{ instanceBuffer, 4, 0 },
-			{ instanceBuffer, 5, 0 },
-		};
-	}
-};
+		if (region->byteSize < byteSize || region->byteSize > byteSize * 2)
+		{
+			region->Release(device);
+			region->Create(device, byteSize, "Tiny2D-Arena");
+			reallocations++;
+		}
 
-struct BoxAttributes
-{
-	Math::float3 position;
-	Math::quat rotation;
-	Math::float3 scale;
-	Math::float4 color;
+		offset = 0;
+		usedBytes = 0;
+		chargedBytes = 0;
 
-	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
-	{
-		static nvrhi::VertexAttributeDesc attributes[] = {
-			{ "POSITION", nvrhi::Format::RGB32_FLOAT,  1, 0, offsetof(BoxAttributes, position), sizeof(BoxAttributes), true  },
-			{ "ROTATION", nvrhi::Format::RGBA32_FLOAT, 1, 1, offsetof(BoxAttributes, rotation), sizeof(BoxAttributes), true  },
-			{ "SCALE",	  nvrhi::Format::RGB32_FLOAT,  1, 2, offsetof(BoxAttributes, scale),    sizeof(BoxAttributes), true  },
-			{ "COLOR",    nvrhi::Format::RGBA32_FLOAT, 1, 3, offsetof(BoxAttributes, color),    sizeof(BoxAttributes), true  },
-		};
+		// the budget starts over every frame, a flushed region still in flight only keeps its buffer
+		flushChargedBytes = 0;
 
-		return attributes;
+		flushCount = 0;
+		flushBytes = 0;
+		flushFallbacks = 0;
 	}
 
-	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::BufferHandle instanceBuffer)
+	bool Flushing() const
 	{
-		return {
-			{ instanceBuffer, 0, 0 },
-			{ instanceBuffer, 1, 0 },
-			{ instanceBuffer, 2, 0 },
-			{ instanceBuffer, 3, 0 },
-		};
+		return budget->limit && budget->policy == Tiny2D::OverflowPolicy::Flush;
 	}
-};
-
-template<typename T>
-struct InstancedPass
-{
-	nvrhi::IDevice* device;
-	nvrhi::BufferHandle instanceBuffer;
-	nvrhi::InputLayoutHandle inputLayout;
-	T* instanceDataBase = nullptr;
-	T* instanceDataPtr = nullptr;
-	uint32_t maxInstanceCount = 5000;
-	uint32_t instanceCount = 0;
-	nvrhi::GraphicsPipelineHandle pso;
 
-	uint32_t vertexCount = 6;
+	// half the budget when flushing, the other half is for the region the GPU reads meanwhile
+	uint64_t MaxByteSize() const
+	{
+		return Flushing() ? Math::max(c_MinByteSize, budget->limit / 2) : budget->limit;
+	}
 
-	void Init(nvrhi::IDevice* pDevice, nvrhi::IShader* vertexShader)
+	Range Allocate(uint64_t size)
 	{
-		CORE_PROFILE_SCOPE_NC("Tiny2D::InstancedPass::init", RENDERING_COLOR);
+		uint64_t start = Align(offset);
+		bool fits = start + size <= region->byteSize;
+		uint64_t charge = fits ? start + size - offset : size;
 
-		device = pDevice;
+		// a full region is flushed instead of grown, so the flushed one and the one written fit in the budget together
+		bool flushFull = !fits && Flushing() && region->byteSize >= MaxByteSize();
 
-		// vertex input
+		if (flushFull || !budget->Charge(charge))
 		{
-			auto att = T::GetVertexAttributeDesc();
-			inputLayout = device->createInputLayout(att.data(), (uint32_t)att.size(), vertexShader);
+			if (OverflowDrawContext(owner))
+			{
+				// the rewound arena may still not fit it when other draw contexts hold the budget,
+				// or while the GPU reads what was just flushed
+				start = 0;
+				charge = size;
+				if (!budget->Charge(charge))
+				{
+					WaitFlush();
+					if (!budget->Charge(charge))
+						return {};
+				}
+			}
+			else if (!flushFull || !budget->Charge(charge))
+			{
+				if (Flushing())
+					flushFallbacks++;
+
+				return {};
+			}
 		}
-		
-		// vertex buffer
+
+		chargedBytes += charge;
+
+		if (start + size > region->byteSize)
 		{
-			nvrhi::BufferDesc instanceBufferDesc;
-			instanceBufferDesc.byteSize = sizeof(T) * maxInstanceCount;
-			instanceBufferDesc.isVertexBuffer = true;
-			instanceBufferDesc.debugName = typeid(T).name();
-			instanceBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
-			instanceBufferDesc.cpuAccess = nvrhi::CpuAccessMode::Write;
-			instanceBuffer = device->createBuffer(instanceBufferDesc);
+			Grow(size);
+			start = 0;
 		}
 
-		instanceDataBase = (T*)device->mapBuffer(instanceBuffer, nvrhi::CpuAccessMode::Write);
+		usedBytes += start + size - offset;
+		offset = start + size;
+
+		return { region->buffer, start, region->mapped + start };
 	}
 
-	void ResizeBuffer(uint32_t size = 0)
+	// nothing allocated so far is referenced by the command list anymore
+	void Rewind()
 	{
-		auto prevMaxQuadCount = maxInstanceCount;
+		peakBytes = Math::max(peakBytes, usedBytes);
+		offset = 0;
+		usedBytes = 0;
+
+		budget->Refund(chargedBytes);
+		chargedBytes = 0;
+	}
 
-		maxInstanceCount = size ? size : maxInstanceCount * 2;
+	// everything allocated so far has just been submitted; the arena carries on in flushRegion once the GPU is done
+	// with what the previous flush submitted there, so a view never holds more than the budget in flight
+	void Flush()
+	{
+		flushCount++;
+		flushBytes += usedBytes;
 
-		LOG_INFO("resize maxInstanceCount {} {} -> {}", typeid(T).name(), prevMaxQuadCount, maxInstanceCount);
+		WaitFlush();
 
-		nvrhi::BufferDesc instanceBufferDesc;
-		instanceBufferDesc.byteSize = sizeof(T) * maxInstanceCount;
-		instanceBufferDesc.isVertexBuffer = true;
-		instanceBufferDesc.debugName = typeid(T).name();
-		instanceBufferDesc.initialState = nvrhi::ResourceStates::CopyDest;
-		instanceBufferDesc.cpuAccess = nvrhi::CpuAccessMode::Write;
+		if (!flushFence)
+			flushFence = device->createEventQuery();
 
-		auto newBuffer = device->createBuffer(instanceBufferDesc);
-		CORE_ASSERT(newBuffer);
+		device->resetEventQuery(flushFence);
+		device->setEventQuery(flushFence, nvrhi::CommandQueue::Graphics);
+		flushPending = true;
 
-		auto newMappedBuffer = (T*)device->mapBuffer(newBuffer, nvrhi::CpuAccessMode::Write);
-		CORE_ASSERT(newMappedBuffer);
+		flushChargedBytes = chargedBytes;
+		chargedBytes = 0;
 
-		std::memcpy(newMappedBuffer, instanceDataBase, instanceCount);
-		device->unmapBuffer(instanceBuffer);
+		uint64_t size = region->byteSize;
+		std::swap(*region, flushRegion);
 
-		instanceDataBase = newMappedBuffer;
-		instanceDataPtr = instanceDataBase + instanceCount;
-		instanceBuffer = newBuffer;
+		if (region->byteSize < size)
+		{
+			region->Release(device);
+			region->Create(device, size, "Tiny2D-Arena");
+			reallocations++;
+		}
 	}
 
-	~InstancedPass()
+	void WaitFlush()
 	{
-		device->unmapBuffer(instanceBuffer);
+		if (!flushPending)
+			return;
+
+		device->waitEventQuery(flushFence);
+		flushPending = false;
+
+		budget->Refund(flushChargedBytes);
+		flushChargedBytes = 0;
 	}
 
-	void Begin()
+	// grows the latest allocation in place when nothing has been allocated after it
+	bool Extend(const Range& range, uint64_t size, uint64_t newSize)
 	{
-		instanceDataPtr = instanceDataBase;
-		instanceCount = 0;
-	}
+		if (range.buffer != region->buffer || range.offset + size != offset || range.offset + newSize > region->byteSize)
+			return false;
 
-	void End(
+		if (!budget->Charge(newSize - size))
+			return false;
+
+		chargedBytes += newSize - size;
+		usedBytes += newSize - size;
+		offset = range.offset + newSize;
+
+		return true;
+	}
+
+	void Grow(uint64_t size)
+	{
+		uint64_t prevByteSize = region->byteSize;
+
+		// enough for everything allocated so far, so the next frame fits in a single buffer
+		byteSize = Math::max(prevByteSize * 2, usedBytes + size + c_Alignment);
+		if (budget->limit)
+			byteSize = Math::min(byteSize, Math::max(MaxByteSize(), size));
+
+		LOG_INFO("resize Arena {} -> {}", prevByteSize, byteSize);
+
+		region->Retire(device, *releaseQueue);
+		region->Create(device, byteSize, "Tiny2D-Arena");
+		reallocations++;
+		offset = 0;
+	}
+};
+
+struct StreamBatch
+{
+	nvrhi::IBuffer* buffer = nullptr;
+	uint64_t offset = 0;
+	uint32_t count = 0;
+	float thickness = 0.0f; // line pass only, pushed as a constant per draw
+};
+
+// Typed append-only stream of a pass, each contiguous arena block becomes one batch
+template<typename T>
+struct ArenaStream
+{
+	static constexpr uint32_t c_MinBlockSize = 256;
+	static constexpr float c_HighWaterDecay = 0.97f;
+
+	Arena* arena = nullptr;
+	std::vector<StreamBatch> batches;
+	// arena allocation ptr writes into, extended as a whole even once LinePass has split it into several batches
+	Arena::Range block;
+	T* ptr = nullptr;
+	T* end = nullptr;
+	uint32_t count = 0;
+	uint32_t dropped = 0;
+	uint32_t blockSize = c_MinBlockSize;
+	uint32_t capacityHint = 0;
+
+	// decaying high-water mark of the per-frame count, one spike fades out instead of pinning the memory
+	float highWater = 0.0f;
+	uint32_t lastCount = 0;
+	uint32_t expected = 0;
+
+	// called before Begin, predicts this frame's count from the previous frames
+	uint64_t ExpectedBytes()
+	{
+		highWater = Math::max(float(count), highWater * c_HighWaterDecay);
+
+		// usage trending up is extrapolated one frame ahead
+		uint32_t trend = count > lastCount ? count - lastCount : 0;
+		lastCount = count;
+
+		expected = Math::max(Math::max(uint32_t(highWater), count + trend), capacityHint);
+
+		return expected ? uint64_t(expected) * sizeof(T) + Arena::c_Alignment : 0;
+	}
+
+	void Begin()
+	{
+		// size the first block after the expected count so a pass normally ends up in one batch
+		blockSize = Math::max(c_MinBlockSize, expected);
+
+		Rewind();
+		count = 0;
+		dropped = 0;
+	}
+
+	// drops the batches once they have been drawn, count keeps adding up over the frame
+	void Rewind()
+	{
+		batches.clear();
+		block = {};
+		ptr = end = nullptr;
+	}
+
+	// drops the batches without drawing them
+	void Discard()
+	{
+		uint32_t pending = 0;
+		for (const StreamBatch& batch : batches)
+			pending += batch.count;
+
+		count -= pending;
+		dropped += pending;
+
+		Rewind();
+	}
+
+	bool Reserve(uint32_t n)
+	{
+		if (uint32_t(end - ptr) >= n)
+			return true;
+
+		uint32_t elements = Math::max(n, blockSize);
+		blockSize = elements * 2;
+
+		// the budget is shared by every pass, no single block may take most of it
+		if (arena->budget->limit)
+			elements = Math::max(n, Math::min(elements, uint32_t(arena->budget->limit / 4 / sizeof(T))));
+
+		if (block.data)
+		{
+			uint64_t size = uint64_t((uint8_t*)end - block.data);
+
+			if (arena->Extend(block, size, size + uint64_t(elements) * sizeof(T)))
+			{
+				end += elements;
+				return true;
+			}
+		}
+
+		Arena::Range range = arena->Allocate(uint64_t(elements) * sizeof(T));
+		if (!range.data && elements > n)
+		{
+			elements = n;
+			range = arena->Allocate(uint64_t(elements) * sizeof(T));
+		}
+
+		if (!range.data)
+			return false;
+
+		batches.push_back({ range.buffer, range.offset, 0 });
+
+		block = range;
+		ptr = (T*)range.data;
+		end = ptr + elements;
+
+		return true;
+	}
+
+	// nullptr when the budget of the view refused the allocation
+	T* Allocate(uint32_t n)
+	{
+		if (!Reserve(n))
+		{
+			dropped += n;
+			return nullptr;
+		}
+
+		T* result = ptr;
+		ptr += n;
+		count += n;
+		batches.back().count += n;
+
+		return result;
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Line Pass
+//////////////////////////////////////////////////////////////////////////
+
+struct LinePass
+{
+	// thickness is constant per batch instead of per vertex
+	struct LineVertex
+	{
+		Math::float3 position;
+		uint32_t color; // RGBA8
+	};
+
+	static_assert(sizeof(LineVertex) == 16);
+
+	// ends every strip, the shaders drop the segments touching it; nvrhi has no primitive restart to do this
+	static constexpr uint32_t c_RestartBits = 0xFFFFFFFF;
+
+	nvrhi::IDevice* device;
+	nvrhi::InputLayoutHandle inputLayout;
+	nvrhi::InputLayoutHandle stripInputLayout;
+	ArenaStream<LineVertex> vertices;
+	ArenaStream<LineVertex> strips;
+	Tiny2D::LineMode mode = Tiny2D::LineMode::GeometryShader;
+
+	// the strip stream also holds the restart vertices, its segments are counted here
+	uint32_t stripSegments = 0;
+	uint32_t pendingStripSegments = 0;
+	uint32_t droppedStripSegments = 0;
+
+	void Init(nvrhi::IDevice* pDevice, Arena* arena, nvrhi::IShader* vertexShader, Tiny2D::LineMode lineMode)
+	{
+		device = pDevice;
+		vertices.arena = arena;
+		strips.arena = arena;
+		mode = lineMode;
+
+		// vertex input
+		if (mode == Tiny2D::LineMode::Instanced)
+		{
+			// the same buffer read per instance, each instance spans both vertices of a segment
+			nvrhi::VertexAttributeDesc attributes[] = {
+				{ "FROM",      nvrhi::Format::RGB32_FLOAT, 1, 0, offsetof(LineVertex, position)                     , 0, true },
+				{ "FROMCOLOR", nvrhi::Format::RGBA8_UNORM, 1, 1, offsetof(LineVertex, color)                        , 0, true },
+				{ "TO",        nvrhi::Format::RGB32_FLOAT, 1, 2, sizeof(LineVertex) + offsetof(LineVertex, position), 0, true },
+				{ "TOCOLOR",   nvrhi::Format::RGBA8_UNORM, 1, 3, sizeof(LineVertex) + offsetof(LineVertex, color)   , 0, true },
+			};
+
+			// lists step two vertices per segment, strips one
+			for (auto& attribute : attributes)
+				attribute.elementStride = sizeof(LineVertex) * 2;
+			inputLayout = device->createInputLayout(attributes, uint32_t(std::size(attributes)), vertexShader);
+
+			for (auto& attribute : attributes)
+				attribute.elementStride = sizeof(LineVertex);
+			stripInputLayout = device->createInputLayout(attributes, uint32_t(std::size(attributes)), vertexShader);
+		}
+		else
+		{
+			nvrhi::VertexAttributeDesc attributes[] = {
+				{ "POSITION",   nvrhi::Format::RGB32_FLOAT,  1, 0, offsetof(LineVertex, position) , sizeof(LineVertex), false },
+				{ "COLOR",      nvrhi::Format::RGBA8_UNORM,  1, 1, offsetof(LineVertex, color)    , sizeof(LineVertex), false },
+			};
+			inputLayout = device->createInputLayout(attributes, uint32_t(std::size(attributes)), vertexShader);
+			stripInputLayout = inputLayout;
+		}
+	}
+
+	void Begin()
+	{
+		vertices.Begin();
+		strips.Begin();
+
+		stripSegments = 0;
+		pendingStripSegments = 0;
+		droppedStripSegments = 0;
+	}
+
+	void Rewind()
+	{
+		vertices.Rewind();
+		strips.Rewind();
+
+		pendingStripSegments = 0;
+	}
+
+	void Discard()
+	{
+		vertices.Discard();
+		strips.Discard();
+
+		stripSegments -= pendingStripSegments;
+		droppedStripSegments += pendingStripSegments;
+		pendingStripSegments = 0;
+	}
+
+	// a thickness different from the one of the current batch splits it where this allocation starts
+	static LineVertex* Allocate(ArenaStream<LineVertex>& stream, uint32_t n, float thickness)
+	{
+		LineVertex* result = stream.Allocate(n);
+		if (!result)
+			return nullptr;
+
+		StreamBatch& batch = stream.batches.back();
+		if (batch.thickness != thickness)
+		{
+			if (batch.count == n)
+			{
+				batch.thickness = thickness;
+			}
+			else
+			{
+				batch.count -= n;
+				StreamBatch split = { batch.buffer, batch.offset + uint64_t(batch.count) * sizeof(LineVertex), n, thickness };
+				stream.batches.push_back(split);
+			}
+		}
+
+		return result;
+	}
+
+	LineVertex* Allocate(uint32_t n, float thickness)
+	{
+		return Allocate(vertices, n, thickness);
+	}
+
+	// room for the n points of a strip, the restart vertex after them is written here
+	LineVertex* AllocateStrip(uint32_t n, float thickness)
+	{
+		LineVertex* result = Allocate(strips, n + 1, thickness);
+		if (!result)
+		{
+			droppedStripSegments += n - 1;
+			return nullptr;
+		}
+
+		result[n].position = Math::float3(std::bit_cast<float>(c_RestartBits), 0.0f, 0.0f);
+		result[n].color = 0;
+
+		stripSegments += n - 1;
+		pendingStripSegments += n - 1;
+
+		return result;
+	}
+
+	void End(
+		nvrhi::ICommandList* commandList, 
+		nvrhi::GraphicsPipelineHandle& pso,
+		nvrhi::GraphicsPipelineHandle& stripPso,
+		nvrhi::IBindingLayout* viewBindingLayout, 
+		nvrhi::IBindingSet* viewBindingSets,
+		nvrhi::IFramebuffer* framebuffer,
+		nvrhi::IShader* vs,
+		nvrhi::IShader* ps,
+		nvrhi::IShader* gs
+	)
+	{
+		CORE_PROFILE_SCOPE_NC("Tiny2D::LinesPass::End", RENDERING_COLOR);
+
+		CORE_ASSERT(commandList);
+		CORE_ASSERT(framebuffer);
+
+		if (vertices.count == 0 && strips.count == 0)
+			return;
+
+		commandList->beginMarker("Lines");
+		Render(commandList, vertices, false, pso, viewBindingLayout, viewBindingSets, framebuffer, vs, ps, gs);
+		Render(commandList, strips, true, stripPso, viewBindingLayout, viewBindingSets, framebuffer, vs, ps, gs);
+		commandList->endMarker();
+	}
+
+	void Render(
+		nvrhi::ICommandList* commandList,
+		const ArenaStream<LineVertex>& stream,
+		bool strip,
+		nvrhi::GraphicsPipelineHandle& pso,
+		nvrhi::IBindingLayout* viewBindingLayout,
+		nvrhi::IBindingSet* viewBindingSets,
+		nvrhi::IFramebuffer* framebuffer,
+		nvrhi::IShader* vs,
+		nvrhi::IShader* ps,
+		nvrhi::IShader* gs
+	)
+	{
+		if (stream.count == 0)
+			return;
+
+		bool instanced = mode == Tiny2D::LineMode::Instanced;
+
+		if (!pso)
+		{
+			nvrhi::GraphicsPipelineDesc psoDesc;
+			psoDesc.VS = vs;
+			psoDesc.PS = ps;
+			psoDesc.GS = instanced ? nullptr : gs;
+			psoDesc.inputLayout = strip ? stripInputLayout : inputLayout;
+			psoDesc.bindingLayouts = { viewBindingLayout };
+			psoDesc.primType = instanced ? nvrhi::PrimitiveType::TriangleList : strip ? nvrhi::PrimitiveType::LineStrip : nvrhi::PrimitiveType::LineList;
+			psoDesc.renderState = {
+				.blendState = {
+					.alphaToCoverageEnable = true,
+				},
+				.depthStencilState = {
+					.depthTestEnable = true
+				},
+				.rasterState = {
+					.cullMode = nvrhi::RasterCullMode::None,
+					.frontCounterClockwise = true,
+					.multisampleEnable = true,
+					.antialiasedLineEnable = true,
+				},
+			};
+
+			pso = device->createGraphicsPipeline(psoDesc, framebuffer);
+			CORE_ASSERT(pso);
+		}
+
+		nvrhi::GraphicsState state;
+		state.pipeline = pso;
+		state.framebuffer = framebuffer;
+		state.viewport.addViewportAndScissorRect(framebuffer->getFramebufferInfo().getViewport());
+		state.bindings = { viewBindingSets };
+
+		for (const StreamBatch& batch : stream.batches)
+		{
+			if (batch.count == 0)
+				continue;
+
+			if (instanced)
+			{
+				state.vertexBuffers = {
+					{ batch.buffer, 0, batch.offset },
+					{ batch.buffer, 1, batch.offset },
+					{ batch.buffer, 2, batch.offset },
+					{ batch.buffer, 3, batch.offset },
+				};
+				commandList->setGraphicsState(state);
+				commandList->setPushConstants(&batch.thickness, sizeof(float));
+
+				// a strip has a segment between every two neighbouring vertices
+				uint32_t segments = strip ? batch.count - 1 : batch.count / 2;
+				commandList->draw({ .vertexCount = 6, .instanceCount = segments });
+			}
+			else
+			{
+				state.vertexBuffers = {
+					{ batch.buffer, 0, batch.offset },
+					{ batch.buffer, 1, batch.offset },
+				};
+				commandList->setGraphicsState(state);
+				commandList->setPushConstants(&batch.thickness, sizeof(float));
+
+				commandList->draw({ .vertexCount = batch.count });
+			}
+		}
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////
+//  Mesh instancing
+//////////////////////////////////////////////////////////////////////////
+
+// What the Draw* calls record per instance. Pack converts it to the layout that is uploaded, the full precision
+// attributes below or their packed variants.
+
+struct SpriteInstance
+{
+	Math::float3 position;
+	Math::quat rotation;
+	Math::float3 scale;
+	Math::float4 uv;
+	Math::float4 color;
+	uint32_t textureID;
+	uint32_t id;
+};
+
+struct CircleInstance
+{
+	Math::float3 position;
+	float radius;
+	Math::quat rotation;
+	Math::float4 color;
+	float thickness;
+};
+
+struct TextInstance
+{
+	Math::float3 position;
+	Math::quat rotation;
+	Math::float3 scale;
+	Math::float4 uv;
+	Math::float4 color;
+	uint32_t textureID;
+};
+
+struct BoxInstance
+{
+	Math::float3 position;
+	Math::quat rotation;
+	Math::float3 scale;
+	Math::float4 color;
+};
+
+// The full precision layouts carry the world matrix, so the vertex shaders transform each vertex with one
+// 3x4 matrix instead of building it from position, rotation and scale for every vertex of the instance.
+struct WorldMatrix
+{
+	Math::float4 rows[3];
+
+	// upper three rows of translation * rotation * scale, as ConstructTransformMatrix in tiny2D.h builds it
+	static WorldMatrix Compose(const Math::float3& position, const Math::quat& rotation, const Math::float3& scale)
+	{
+		Math::float3x3 r = Math::float3x3(Math::normalize(rotation));
+
+		WorldMatrix m;
+		for (int i = 0; i < 3; i++)
+			m.rows[i] = Math::float4(r[0][i] * scale.x, r[1][i] * scale.y, r[2][i] * scale.z, position[i]);
+
+		return m;
+	}
+};
+
+// the three rows of a WorldMatrix at offset, declared first in every full precision layout
+#define WORLD_MATRIX_ATTRIBUTES(T, offset) \
+	{ "WORLDX", nvrhi::Format::RGBA32_FLOAT, 1, 0, (offset),                            sizeof(T), true }, \
+	{ "WORLDY", nvrhi::Format::RGBA32_FLOAT, 1, 1, (offset) + sizeof(Math::float4),     sizeof(T), true }, \
+	{ "WORLDZ", nvrhi::Format::RGBA32_FLOAT, 1, 2, (offset) + sizeof(Math::float4) * 2, sizeof(T), true }
+
+struct spriteAttributes
+{
+	WorldMatrix world;
+	glm::vec4 uv;
+	Math::float4 color;
+	uint32_t textureID;
+	uint32_t id;
+
+	static spriteAttributes Pack(const SpriteInstance& a)
+	{
+		spriteAttributes p;
+		p.world = WorldMatrix::Compose(a.position, a.rotation, a.scale);
+		p.uv = a.uv;
+		p.color = a.color;
+		p.textureID = a.textureID;
+		p.id = a.id;
+
+		return p;
+	}
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			WORLD_MATRIX_ATTRIBUTES(spriteAttributes, offsetof(spriteAttributes, world)),
+			{ "UV",		   nvrhi::Format::RGBA32_FLOAT,	1, 3, offsetof(spriteAttributes, uv),		 sizeof(spriteAttributes), true },
+			{ "COLOR",     nvrhi::Format::RGBA32_FLOAT,	1, 4, offsetof(spriteAttributes, color),	 sizeof(spriteAttributes), true },
+			{ "TEXTUREID", nvrhi::Format::R32_SINT,		1, 5, offsetof(spriteAttributes, textureID), sizeof(spriteAttributes), true },
+			{ "ENTITYID",  nvrhi::Format::R32_SINT,		1, 6, offsetof(spriteAttributes, id)       , sizeof(spriteAttributes), true },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return {
+			{ instanceBuffer, 0, offset },
+			{ instanceBuffer, 1, offset },
+			{ instanceBuffer, 2, offset },
+			{ instanceBuffer, 3, offset },
+			{ instanceBuffer, 4, offset },
+			{ instanceBuffer, 5, offset },
+			{ instanceBuffer, 6, offset },
+		};
+	}
+};
+
+struct CircleAttributes
+{
+	WorldMatrix world;
+	Math::float4 color;
+	float thickness;
+
+	static CircleAttributes Pack(const CircleInstance& a)
+	{
+		CircleAttributes p;
+		p.world = WorldMatrix::Compose(a.position, a.rotation, Math::float3(a.radius * 2.0f));
+		p.color = a.color;
+		p.thickness = a.thickness;
+
+		return p;
+	}
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			WORLD_MATRIX_ATTRIBUTES(CircleAttributes, offsetof(CircleAttributes, world)),
+			{ "COLOR",       nvrhi::Format::RGBA32_FLOAT,  1, 3, offsetof(CircleAttributes, color),		sizeof(CircleAttributes), true },
+			{ "THICKNESS",   nvrhi::Format::R32_FLOAT,     1, 4, offsetof(CircleAttributes, thickness), sizeof(CircleAttributes), true },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return {
+			{ instanceBuffer, 0, offset },
+			{ instanceBuffer, 1, offset },
+			{ instanceBuffer, 2, offset },
+			{ instanceBuffer, 3, offset },
+			{ instanceBuffer, 4, offset },
+		};
+	}
+};
+
+struct TextAttributes
+{
+	WorldMatrix world;
+	glm::vec4 uv;
+	glm::vec4 color;
+	uint32_t textureID;
+
+	static TextAttributes Pack(const TextInstance& a)
+	{
+		TextAttributes p;
+		p.world = WorldMatrix::Compose(a.position, a.rotation, a.scale);
+		p.uv = a.uv;
+		p.color = a.color;
+		p.textureID = a.textureID;
+
+		return p;
+	}
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			WORLD_MATRIX_ATTRIBUTES(TextAttributes, offsetof(TextAttributes, world)),
+			{ "UV",		   nvrhi::Format::RGBA32_FLOAT,  1, 3, offsetof(TextAttributes, uv),		sizeof(TextAttributes), true },
+			{ "COLOR",     nvrhi::Format::RGBA32_FLOAT,  1, 4, offsetof(TextAttributes, color),	    sizeof(TextAttributes), true },
+			{ "TEXTUREID", nvrhi::Format::R32_UINT,      1, 5, offsetof(TextAttributes, textureID), sizeof(TextAttributes), true },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return {
+			{ instanceBuffer, 0, offset },
+			{ instanceBuffer, 1, offset },
+			{ instanceBuffer, 2, offset },
+			{ instanceBuffer, 3, offset },
+			{ instanceBuffer, 4, offset },
+			{ instanceBuffer, 5, offset },
+		};
+	}
+};
+
+struct BoxAttributes
+{
+	WorldMatrix world;
+	Math::float4 color;
+
+	static BoxAttributes Pack(const BoxInstance& a)
+	{
+		BoxAttributes p;
+		p.world = WorldMatrix::Compose(a.position, a.rotation, a.scale);
+		p.color = a.color;
+
+		return p;
+	}
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			WORLD_MATRIX_ATTRIBUTES(BoxAttributes, offsetof(BoxAttributes, world)),
+			{ "COLOR",    nvrhi::Format::RGBA32_FLOAT, 1, 3, offsetof(BoxAttributes, color),    sizeof(BoxAttributes), true  },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return {
+			{ instanceBuffer, 0, offset },
+			{ instanceBuffer, 1, offset },
+			{ instanceBuffer, 2, offset },
+			{ instanceBuffer, 3, offset },
+		};
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////
+//  Packed instancing
+//////////////////////////////////////////////////////////////////////////
+
+// Compact variants of the attributes above, selected with InitDesc::packedInstances.
+// Colors are RGBA8, scales are halfs, uv rectangles are 16-bit unorm and rotations are smallest-three quaternions,
+// positions stay full floats. Decoded by main_vs_packed of each shader, which still builds the world matrix per vertex.
+
+static uint32_t PackColor(const Math::float4& color)
+{
+	return glm::packUnorm4x8(color);
+}
+
+static void PackHalf4(const Math::float4& v, uint32_t out[2])
+{
+	out[0] = glm::packHalf2x16(Math::float2(v.x, v.y));
+	out[1] = glm::packHalf2x16(Math::float2(v.z, v.w));
+}
+
+// uv rectangles lie in [0, 1], unorm keeps an even 1/65535 step where halfs lose texels towards 1
+static void PackUnorm4(const Math::float4& v, uint32_t out[2])
+{
+	out[0] = glm::packUnorm2x16(Math::float2(v.x, v.y));
+	out[1] = glm::packUnorm2x16(Math::float2(v.z, v.w));
+}
+
+// 2 bits for the index of the largest component, which is rebuilt from the other three at 10 bits each
+static uint32_t PackQuaternion(Math::quat q)
+{
+	q = Math::normalize(q);
+	float c[4] = { q.x, q.y, q.z, q.w };
+
+	uint32_t largest = 0;
+	for (uint32_t i = 1; i < 4; i++)
+	{
+		if (Math::abs(c[i]) > Math::abs(c[largest]))
+			largest = i;
+	}
+
+	// q and -q are the same rotation, flip so the dropped component is positive
+	float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+
+	uint32_t packed = largest << 30;
+	uint32_t shift = 20;
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		if (i == largest)
+			continue;
+
+		// the other components lie within [-1/sqrt(2), 1/sqrt(2)]
+		float v = Math::clamp(c[i] * sign * Math::root_two<float>() * 0.5f + 0.5f, 0.0f, 1.0f);
+		packed |= uint32_t(v * 1023.0f + 0.5f) << shift;
+		shift -= 10;
+	}
+
+	return packed;
+}
+
+struct PackedSpriteAttributes
+{
+	Math::float3 position;
+	uint32_t rotation;
+	uint32_t scale[2];
+	uint32_t uv[2];
+	uint32_t color;
+	uint32_t textureID;
+	uint32_t id;
+
+	static PackedSpriteAttributes Pack(const SpriteInstance& a)
+	{
+		PackedSpriteAttributes p;
+		p.position = a.position;
+		p.rotation = PackQuaternion(a.rotation);
+		PackHalf4(Math::float4(a.scale, 0.0f), p.scale);
+		PackUnorm4(a.uv, p.uv);
+		p.color = PackColor(a.color);
+		p.textureID = a.textureID;
+		p.id = a.id;
+
+		return p;
+	}
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			{ "POSITION",  nvrhi::Format::RGB32_FLOAT,	 1, 0, offsetof(PackedSpriteAttributes, position),  sizeof(PackedSpriteAttributes), true },
+			{ "ROTATION",  nvrhi::Format::R32_UINT,		 1, 1, offsetof(PackedSpriteAttributes, rotation),  sizeof(PackedSpriteAttributes), true },
+			{ "SCALE",	   nvrhi::Format::RGBA16_FLOAT,	 1, 2, offsetof(PackedSpriteAttributes, scale),	    sizeof(PackedSpriteAttributes), true },
+			{ "UV",		   nvrhi::Format::RGBA16_UNORM,	 1, 3, offsetof(PackedSpriteAttributes, uv),		sizeof(PackedSpriteAttributes), true },
+			{ "COLOR",     nvrhi::Format::RGBA8_UNORM,	 1, 4, offsetof(PackedSpriteAttributes, color),	    sizeof(PackedSpriteAttributes), true },
+			{ "TEXTUREID", nvrhi::Format::R32_SINT,		 1, 5, offsetof(PackedSpriteAttributes, textureID), sizeof(PackedSpriteAttributes), true },
+			{ "ENTITYID",  nvrhi::Format::R32_SINT,		 1, 6, offsetof(PackedSpriteAttributes, id)       , sizeof(PackedSpriteAttributes), true },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return spriteAttributes::GetVertexBuffers(instanceBuffer, offset);
+	}
+};
+
+struct PackedCircleAttributes
+{
+	Math::float3 position;
+	float radius;
+	uint32_t rotation;
+	uint32_t color;
+	uint16_t thickness;
+	uint16_t padding;
+
+	static PackedCircleAttributes Pack(const CircleInstance& a)
+	{
+		PackedCircleAttributes p;
+		p.position = a.position;
+		p.radius = a.radius;
+		p.rotation = PackQuaternion(a.rotation);
+		p.color = PackColor(a.color);
+		p.thickness = uint16_t(glm::packHalf1x16(a.thickness));
+		p.padding = 0;
+
+		return p;
+	}
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			{ "POSITION",	 nvrhi::Format::RGB32_FLOAT,   1, 0, offsetof(PackedCircleAttributes, position),  sizeof(PackedCircleAttributes), true },
+			{ "RADIUS",		 nvrhi::Format::R32_FLOAT,     1, 1, offsetof(PackedCircleAttributes, radius),	  sizeof(PackedCircleAttributes), true },
+			{ "ROTATION",	 nvrhi::Format::R32_UINT,      1, 2, offsetof(PackedCircleAttributes, rotation),  sizeof(PackedCircleAttributes), true },
+			{ "COLOR",       nvrhi::Format::RGBA8_UNORM,   1, 3, offsetof(PackedCircleAttributes, color),	  sizeof(PackedCircleAttributes), true },
+			{ "THICKNESS",   nvrhi::Format::R16_FLOAT,     1, 4, offsetof(PackedCircleAttributes, thickness), sizeof(PackedCircleAttributes), true },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return CircleAttributes::GetVertexBuffers(instanceBuffer, offset);
+	}
+};
+
+struct PackedTextAttributes
+{
+	Math::float3 position;
+	uint32_t rotation;
+	uint32_t scale[2];
+	uint32_t uv[2];
+	uint32_t color;
+	uint32_t textureID;
+
+	static PackedTextAttributes Pack(const TextInstance& a)
+	{
+		PackedTextAttributes p;
+		p.position = a.position;
+		p.rotation = PackQuaternion(a.rotation);
+		PackHalf4(Math::float4(a.scale, 0.0f), p.scale);
+		PackUnorm4(a.uv, p.uv);
+		p.color = PackColor(a.color);
+		p.textureID = a.textureID;
+
+		return p;
+	}
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			{ "POSITION",  nvrhi::Format::RGB32_FLOAT,   1, 0, offsetof(PackedTextAttributes, position),  sizeof(PackedTextAttributes), true },
+			{ "ROTATION",  nvrhi::Format::R32_UINT,	     1, 1, offsetof(PackedTextAttributes, rotation),  sizeof(PackedTextAttributes), true },
+			{ "SCALE",	   nvrhi::Format::RGBA16_FLOAT,	 1, 2, offsetof(PackedTextAttributes, scale),	  sizeof(PackedTextAttributes), true },
+			{ "UV",		   nvrhi::Format::RGBA16_UNORM,  1, 3, offsetof(PackedTextAttributes, uv),		  sizeof(PackedTextAttributes), true },
+			{ "COLOR",     nvrhi::Format::RGBA8_UNORM,   1, 4, offsetof(PackedTextAttributes, color),	  sizeof(PackedTextAttributes), true },
+			{ "TEXTUREID", nvrhi::Format::R32_UINT,      1, 5, offsetof(PackedTextAttributes, textureID), sizeof(PackedTextAttributes), true },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return TextAttributes::GetVertexBuffers(instanceBuffer, offset);
+	}
+};
+
+struct PackedBoxAttributes
+{
+	Math::float3 position;
+	uint32_t rotation;
+	uint32_t scale[2];
+	uint32_t color;
+
+	static PackedBoxAttributes Pack(const BoxInstance& a)
+	{
+		PackedBoxAttributes p;
+		p.position = a.position;
+		p.rotation = PackQuaternion(a.rotation);
+		PackHalf4(Math::float4(a.scale, 0.0f), p.scale);
+		p.color = PackColor(a.color);
+
+		return p;
+	}
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			{ "POSITION", nvrhi::Format::RGB32_FLOAT,  1, 0, offsetof(PackedBoxAttributes, position), sizeof(PackedBoxAttributes), true  },
+			{ "ROTATION", nvrhi::Format::R32_UINT,     1, 1, offsetof(PackedBoxAttributes, rotation), sizeof(PackedBoxAttributes), true  },
+			{ "SCALE",	  nvrhi::Format::RGBA16_FLOAT, 1, 2, offsetof(PackedBoxAttributes, scale),    sizeof(PackedBoxAttributes), true  },
+			{ "COLOR",    nvrhi::Format::RGBA8_UNORM,  1, 3, offsetof(PackedBoxAttributes, color),    sizeof(PackedBoxAttributes), true  },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return BoxAttributes::GetVertexBuffers(instanceBuffer, offset);
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////
+//  2D instancing
+//////////////////////////////////////////////////////////////////////////
+
+// Quad2DDesc and Circle2DDesc, one layout whatever InitDesc::packedInstances says. Colors are RGBA8,
+// sizes stay full floats and uvs are 16-bit unorm so sprites of large atlases sample whole texels.
+// Quads keep angle and layer as halfs, main_vs_2d rotates around z with a sincos instead of a quaternion.
+
+struct Sprite2DAttributes
+{
+	Math::float2 position;
+	uint32_t angleLayer;
+	Math::float2 size;
+	uint32_t uv[2];
+	uint32_t color;
+	uint32_t textureID;
+	uint32_t id;
+
+	static Sprite2DAttributes Pack(const Tiny2D::Quad2DDesc& desc, int textureID)
+	{
+		Sprite2DAttributes p;
+		p.position = desc.position;
+		p.angleLayer = glm::packHalf2x16(Math::float2(desc.angle, desc.layer));
+		p.size = desc.size;
+		PackUnorm4(Math::float4(desc.minUV, desc.maxUV), p.uv);
+		p.color = PackColor(desc.color);
+		p.textureID = textureID;
+		p.id = desc.id;
+
+		return p;
+	}
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			{ "POSITION",   nvrhi::Format::RG32_FLOAT,	 1, 0, offsetof(Sprite2DAttributes, position),   sizeof(Sprite2DAttributes), true },
+			{ "ANGLELAYER", nvrhi::Format::RG16_FLOAT,	 1, 1, offsetof(Sprite2DAttributes, angleLayer), sizeof(Sprite2DAttributes), true },
+			{ "SCALE",	    nvrhi::Format::RG32_FLOAT,	 1, 2, offsetof(Sprite2DAttributes, size),		 sizeof(Sprite2DAttributes), true },
+			{ "UV",		    nvrhi::Format::RGBA16_UNORM, 1, 3, offsetof(Sprite2DAttributes, uv),		 sizeof(Sprite2DAttributes), true },
+			{ "COLOR",      nvrhi::Format::RGBA8_UNORM,	 1, 4, offsetof(Sprite2DAttributes, color),	     sizeof(Sprite2DAttributes), true },
+			{ "TEXTUREID",  nvrhi::Format::R32_SINT,	 1, 5, offsetof(Sprite2DAttributes, textureID),  sizeof(Sprite2DAttributes), true },
+			{ "ENTITYID",   nvrhi::Format::R32_SINT,	 1, 6, offsetof(Sprite2DAttributes, id)       ,  sizeof(Sprite2DAttributes), true },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return {
+			{ instanceBuffer, 0, offset },
+			{ instanceBuffer, 1, offset },
+			{ instanceBuffer, 2, offset },
+			{ instanceBuffer, 3, offset },
+			{ instanceBuffer, 4, offset },
+			{ instanceBuffer, 5, offset },
+			{ instanceBuffer, 6, offset },
+		};
+	}
+};
+
+struct Circle2DAttributes
+{
+	Math::float2 position;
+	float radius;
+	float layer;
+	uint32_t color;
+	float thickness;
+
+	static Circle2DAttributes Pack(const Tiny2D::Circle2DDesc& desc)
+	{
+		Circle2DAttributes p;
+		p.position = desc.position;
+		p.radius = desc.radius;
+		p.layer = desc.layer;
+		p.color = PackColor(desc.color);
+		p.thickness = desc.thickness;
+
+		return p;
+	}
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			{ "TRANSFORM", nvrhi::Format::RGBA32_FLOAT, 1, 0, offsetof(Circle2DAttributes, position),  sizeof(Circle2DAttributes), true },
+			{ "COLOR",     nvrhi::Format::RGBA8_UNORM,  1, 1, offsetof(Circle2DAttributes, color),	   sizeof(Circle2DAttributes), true },
+			{ "THICKNESS", nvrhi::Format::R32_FLOAT,    1, 2, offsetof(Circle2DAttributes, thickness), sizeof(Circle2DAttributes), true },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return {
+			{ instanceBuffer, 0, offset },
+			{ instanceBuffer, 1, offset },
+			{ instanceBuffer, 2, offset },
+		};
+	}
+};
+
+static_assert(sizeof(Sprite2DAttributes) == 40);
+static_assert(sizeof(Circle2DAttributes) == 24);
+
+template<typename T>
+struct InstancedPass
+{
+	nvrhi::IDevice* device;
+	nvrhi::InputLayoutHandle inputLayout;
+	ArenaStream<T> instances;
+
+	void Init(nvrhi::IDevice* pDevice, Arena* arena, nvrhi::IShader* vertexShader)
+	{
+		CORE_PROFILE_SCOPE_NC("Tiny2D::InstancedPass::init", RENDERING_COLOR);
+
+		device = pDevice;
+		instances.arena = arena;
+
+		// vertex input
+		{
+			auto att = T::GetVertexAttributeDesc();
+			inputLayout = device->createInputLayout(att.data(), (uint32_t)att.size(), vertexShader);
+		}
+	}
+
+	void Begin()
+	{
+		instances.Begin();
+	}
+
+	void End(
 		nvrhi::ICommandList* commandList,
+		nvrhi::GraphicsPipelineHandle& pso,
 		nvrhi::BindingLayoutVector bindingLayouts,
 		nvrhi::BindingSetVector bindings,
 		nvrhi::IFramebuffer* fb,
@@ -823,24 +1920,459 @@ struct InstancedPass
 	{
 		CORE_PROFILE_SCOPE_NC("Tiny2D::InstancedPass::Render", RENDERING_COLOR);
 
+		if (instances.count == 0)
+			return;
+
 		if (!pso)
 		{
 
 			CORE_PROFILE_SCOPE_NC("Tiny2D::InstancedPass::CreatePipeline", RENDERING_COLOR);
 			nvrhi::GraphicsPipelineDesc psoDesc;
-
+
+			psoDesc.VS = vs;
+			psoDesc.PS = ps;
+			psoDesc.GS = gs ? gs : psoDesc.GS.Get();
+			psoDesc.inputLayout = inputLayout;
+			psoDesc.bindingLayouts = bindingLayouts;
+			psoDesc.primType = primType;
+			psoDesc.renderState = {
+				.blendState = {
+					.alphaToCoverageEnable = true,
+				},
+				.depthStencilState = {
+					.depthTestEnable = true,
+				},
+				.rasterState = {
+					.cullMode = nvrhi::RasterCullMode::None,
+					.frontCounterClockwise = true,
+					.multisampleEnable = true,
+					.antialiasedLineEnable = true,
+				},
+			};
+
+			for (uint32_t i = 0; i < fb->getDesc().colorAttachments.size(); i++)
+			{
+				nvrhi::Format format = fb->getDesc().colorAttachments[i].texture->getDesc().format;
+				nvrhi::FormatInfo formatInfo = nvrhi::getFormatInfo(format);
+
+				if (formatInfo.hasAlpha)
+				{
+					psoDesc.renderState.blendState.targets[i] = {
+						.blendEnable = true,
+						.srcBlend = nvrhi::BlendFactor::SrcAlpha,
+						.destBlend = nvrhi::BlendFactor::InvSrcAlpha,
+						.blendOp = nvrhi::BlendOp::Add,
+						.srcBlendAlpha = nvrhi::BlendFactor::One,
+						.destBlendAlpha = nvrhi::BlendFactor::One,
+						.blendOpAlpha = nvrhi::BlendOp::Add,
+						.colorWriteMask = nvrhi::ColorMask::All,
+					};
+				}
+			}
+
+			pso = device->createGraphicsPipeline(psoDesc, fb);
+			CORE_ASSERT(pso);
+		}
+
+		// draw
+		{
+			CORE_PROFILE_SCOPE_NC("Tiny2D::InstancedPass::draw", RENDERING_COLOR);
+
+			nvrhi::GraphicsState state;
+			state.pipeline = pso;
+			state.framebuffer = fb;
+			state.viewport.addViewportAndScissorRect(fb->getFramebufferInfo().getViewport());
+
+			commandList->beginMarker(typeid(T).name());
+			{
+				state.bindings = bindings;
+
+				for (const StreamBatch& batch : instances.batches)
+				{
+					if (batch.count == 0)
+						continue;
+
+					state.vertexBuffers = T::GetVertexBuffers(batch.buffer, batch.offset);
+					commandList->setGraphicsState(state);
+					commandList->draw({ 
+						.vertexCount = vertexCount, 
+						.instanceCount = batch.count 
+					});
+				}
+			}
+			commandList->endMarker();
+		}
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Wire shapes
+//////////////////////////////////////////////////////////////////////////
+
+// Only the parameters of each shape are uploaded, wire.hlsl generates the edges from SV_VertexID
+// and expands them to screen space quads like the instanced lines.
+
+enum class WireShape : uint32_t
+{
+	Box,
+	Cylinder,
+	Capsule,
+
+	Count
+};
+
+struct WireShapeAttributes
+{
+	Math::float3 position;
+	Math::quat rotation;
+	Math::float3 scale; // size of a box, radius and height of the round shapes
+	Math::float4 color;
+	float thickness;
+	WireShape shape;
+	uint32_t segments; // of every full circle
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			{ "POSITION",  nvrhi::Format::RGB32_FLOAT,  1, 0, offsetof(WireShapeAttributes, position),  sizeof(WireShapeAttributes), true },
+			{ "ROTATION",  nvrhi::Format::RGBA32_FLOAT, 1, 1, offsetof(WireShapeAttributes, rotation),  sizeof(WireShapeAttributes), true },
+			{ "SCALE",     nvrhi::Format::RGB32_FLOAT,  1, 2, offsetof(WireShapeAttributes, scale),     sizeof(WireShapeAttributes), true },
+			{ "COLOR",     nvrhi::Format::RGBA32_FLOAT, 1, 3, offsetof(WireShapeAttributes, color),     sizeof(WireShapeAttributes), true },
+			{ "THICKNESS", nvrhi::Format::R32_FLOAT,    1, 4, offsetof(WireShapeAttributes, thickness), sizeof(WireShapeAttributes), true },
+			{ "SHAPE",     nvrhi::Format::R32_UINT,     1, 5, offsetof(WireShapeAttributes, shape),     sizeof(WireShapeAttributes), true },
+			{ "SEGMENTS",  nvrhi::Format::R32_UINT,     1, 6, offsetof(WireShapeAttributes, segments),  sizeof(WireShapeAttributes), true },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return {
+			{ instanceBuffer, 0, offset },
+			{ instanceBuffer, 1, offset },
+			{ instanceBuffer, 2, offset },
+			{ instanceBuffer, 3, offset },
+			{ instanceBuffer, 4, offset },
+			{ instanceBuffer, 5, offset },
+			{ instanceBuffer, 6, offset },
+		};
+	}
+};
+
+// one pass per shape and level of detail, so each draw knows how many edges its instances expand to.
+// Boxes only use level 0, the circles of the round shapes have CircleSegments(level) segments
+struct WirePass
+{
+	static constexpr uint32_t c_LevelCount = 4;
+
+	InstancedPass<WireShapeAttributes> shapes[(size_t)WireShape::Count][c_LevelCount];
+
+	static constexpr uint32_t CircleSegments(uint32_t level)
+	{
+		return 4u << level;
+	}
+
+	static constexpr uint32_t SegmentCount(WireShape shape, uint32_t level)
+	{
+		switch (shape)
+		{
+		case WireShape::Box:      return 12;
+		case WireShape::Cylinder: return 4 + 2 * CircleSegments(level);
+		case WireShape::Capsule:  return 4 + 4 * CircleSegments(level);
+		default:                  return 0;
+		}
+	}
+
+	static constexpr uint32_t LevelCount(WireShape shape)
+	{
+		return shape == WireShape::Box ? 1 : c_LevelCount;
+	}
+
+	void Init(nvrhi::IDevice* device, Arena* arena, nvrhi::IShader* vertexShader)
+	{
+		for (uint32_t shape = 0; shape < (uint32_t)WireShape::Count; shape++)
+		{
+			for (uint32_t level = 0; level < LevelCount((WireShape)shape); level++)
+				shapes[shape][level].Init(device, arena, vertexShader);
+		}
+	}
+
+	uint64_t ExpectedBytes()
+	{
+		uint64_t bytes = 0;
+		ForEachStream([&](auto& stream) { bytes += stream.ExpectedBytes(); });
+
+		return bytes;
+	}
+
+	void Begin()
+	{
+		for (auto& levels : shapes)
+			for (auto& pass : levels)
+				pass.Begin();
+	}
+
+	void Rewind()
+	{
+		ForEachStream([](auto& stream) { stream.Rewind(); });
+	}
+
+	void Discard()
+	{
+		ForEachStream([](auto& stream) { stream.Discard(); });
+	}
+
+	template<typename F>
+	void ForEachStream(F&& f)
+	{
+		for (auto& levels : shapes)
+			for (auto& pass : levels)
+				f(pass.instances);
+	}
+
+	WireShapeAttributes* Allocate(WireShape shape, uint32_t level = 0)
+	{
+		WireShapeAttributes* instance = shapes[(size_t)shape][level].instances.Allocate(1);
+		if (instance)
+		{
+			instance->shape = shape;
+			instance->segments = CircleSegments(level);
+		}
+
+		return instance;
+	}
+
+	// segments of every instance drawn and dropped so far
+	uint32_t SegmentCount() const
+	{
+		uint32_t count = 0;
+		for (uint32_t shape = 0; shape < (uint32_t)WireShape::Count; shape++)
+			for (uint32_t level = 0; level < c_LevelCount; level++)
+				count += shapes[shape][level].instances.count * SegmentCount((WireShape)shape, level);
+
+		return count;
+	}
+
+	uint32_t DroppedSegmentCount() const
+	{
+		uint32_t count = 0;
+		for (uint32_t shape = 0; shape < (uint32_t)WireShape::Count; shape++)
+			for (uint32_t level = 0; level < c_LevelCount; level++)
+				count += shapes[shape][level].instances.dropped * SegmentCount((WireShape)shape, level);
+
+		return count;
+	}
+
+	void End(
+		nvrhi::ICommandList* commandList,
+		nvrhi::GraphicsPipelineHandle& pso,
+		nvrhi::BindingLayoutVector bindingLayouts,
+		nvrhi::BindingSetVector bindings,
+		nvrhi::IFramebuffer* fb,
+		nvrhi::IShader* vs,
+		nvrhi::IShader* ps
+	)
+	{
+		for (uint32_t shape = 0; shape < (uint32_t)WireShape::Count; shape++)
+		{
+			for (uint32_t level = 0; level < c_LevelCount; level++)
+			{
+				uint32_t vertexCount = SegmentCount((WireShape)shape, level) * 6;
+				shapes[shape][level].End(commandList, pso, bindingLayouts, bindings, fb, vs, ps, nullptr, vertexCount);
+			}
+		}
+	}
+};
+
+// axis aligned boxes only upload their corners, drawn by main_vs_aabb
+struct AABBAttributes
+{
+	Math::float3 min;
+	Math::float3 max;
+	uint32_t color; // RGBA8
+	float thickness;
+
+	static std::span<nvrhi::VertexAttributeDesc> GetVertexAttributeDesc()
+	{
+		static nvrhi::VertexAttributeDesc attributes[] = {
+			{ "MIN",       nvrhi::Format::RGB32_FLOAT, 1, 0, offsetof(AABBAttributes, min),       sizeof(AABBAttributes), true },
+			{ "MAX",       nvrhi::Format::RGB32_FLOAT, 1, 1, offsetof(AABBAttributes, max),       sizeof(AABBAttributes), true },
+			{ "COLOR",     nvrhi::Format::RGBA8_UNORM, 1, 2, offsetof(AABBAttributes, color),     sizeof(AABBAttributes), true },
+			{ "THICKNESS", nvrhi::Format::R32_FLOAT,   1, 3, offsetof(AABBAttributes, thickness), sizeof(AABBAttributes), true },
+		};
+
+		return attributes;
+	}
+
+	static nvrhi::static_vector<nvrhi::VertexBufferBinding, nvrhi::c_MaxVertexAttributes> GetVertexBuffers(nvrhi::IBuffer* instanceBuffer, uint64_t offset)
+	{
+		return {
+			{ instanceBuffer, 0, offset },
+			{ instanceBuffer, 1, offset },
+			{ instanceBuffer, 2, offset },
+			{ instanceBuffer, 3, offset },
+		};
+	}
+};
+
+static_assert(sizeof(AABBAttributes) == 32);
+
+// meshes that are already on the GPU, main_vs_mesh reads their triangles straight from the buffers
+struct MeshWireframeConstants
+{
+	Math::float4x4 transform;
+	Math::float4 color;
+	uint32_t vertexOffset;
+	uint32_t vertexStride;
+	uint32_t indexOffset;
+	uint32_t indexSize; // bytes per index, 0 for consecutive vertices
+	float thickness;
+	float padding[3];
+};
+
+static_assert(sizeof(MeshWireframeConstants) <= nvrhi::c_MaxPushConstantSize);
+
+struct MeshWireframePass
+{
+	// holds the buffers until the draw is recorded
+	struct Draw
+	{
+		nvrhi::BufferHandle vertexBuffer;
+		nvrhi::BufferHandle indexBuffer;
+		uint32_t triangleCount;
+		MeshWireframeConstants constants;
+		nvrhi::BindingSetHandle bindingSet; // resolved up front for static batches, from the cache otherwise
+	};
+
+	// the buffers of a mesh are usually drawn every frame, their binding set is reused until a frame goes by without them
+	struct BindingKey
+	{
+		nvrhi::IBuffer* vertexBuffer;
+		nvrhi::IBuffer* indexBuffer;
+
+		bool operator==(const BindingKey&) const = default;
+	};
+
+	struct BindingKeyHasher
+	{
+		size_t operator()(const BindingKey& key) const
+		{
+			size_t hash = 0;
+			nvrhi::hash_combine(hash, key.vertexBuffer);
+			nvrhi::hash_combine(hash, key.indexBuffer);
+			return hash;
+		}
+	};
+
+	struct CachedBindingSet
+	{
+		nvrhi::BindingSetHandle bindingSet;
+		bool used = false;
+	};
+
+	nvrhi::IDevice* device = nullptr;
+	DeferredReleaseQueue* releaseQueue = nullptr;
+	nvrhi::IBindingLayout* bindingLayout = nullptr;
+	std::vector<Draw> draws;
+	std::unordered_map<BindingKey, CachedBindingSet, BindingKeyHasher> bindingSets;
+	uint32_t edgeCount = 0; // drawn over the frame
+
+	void Init(nvrhi::IDevice* pDevice, DeferredReleaseQueue* pReleaseQueue, nvrhi::IBindingLayout* pBindingLayout)
+	{
+		device = pDevice;
+		releaseQueue = pReleaseQueue;
+		bindingLayout = pBindingLayout;
+	}
+
+	void Begin()
+	{
+		draws.clear();
+		edgeCount = 0;
+
+		// a set holds its buffers alive, the ones unused last frame go so released meshes are freed;
+		// command lists of earlier frames may still reference them
+		std::erase_if(bindingSets, [this](const auto& entry) {
+			if (!entry.second.used)
+				releaseQueue->Retire(entry.second.bindingSet);
+
+			return !entry.second.used;
+		});
+
+		for (auto& [key, cached] : bindingSets)
+			cached.used = false;
+	}
+
+	// the view constants are bound by a set of their own, so the set of a mesh is the same in every view
+	nvrhi::BindingSetHandle CreateBindingSet(const Draw& draw)
+	{
+		nvrhi::BindingSetDesc bindingSetDesc;
+		bindingSetDesc.bindings = {
+			nvrhi::BindingSetItem::PushConstants(1, sizeof(MeshWireframeConstants)),
+			nvrhi::BindingSetItem::RawBuffer_SRV(0, draw.vertexBuffer),
+			nvrhi::BindingSetItem::RawBuffer_SRV(1, draw.indexBuffer ? draw.indexBuffer : draw.vertexBuffer),
+		};
+
+		nvrhi::BindingSetHandle bindingSet = device->createBindingSet(bindingSetDesc, bindingLayout);
+		CORE_ASSERT(bindingSet);
+
+		return bindingSet;
+	}
+
+	nvrhi::IBindingSet* GetBindingSet(const Draw& draw)
+	{
+		if (draw.bindingSet)
+			return draw.bindingSet;
+
+		CachedBindingSet& cached = bindingSets[{ draw.vertexBuffer, draw.indexBuffer }];
+		cached.used = true;
+
+		if (!cached.bindingSet)
+			cached.bindingSet = CreateBindingSet(draw);
+
+		return cached.bindingSet;
+	}
+
+	// a static batch is drawn by any thread and view at once, End must not touch the cache for it
+	void ResolveBindingSets()
+	{
+		for (Draw& draw : draws)
+			draw.bindingSet = CreateBindingSet(draw);
+	}
+
+	void Rewind()
+	{
+		draws.clear();
+	}
+
+	void End(
+		nvrhi::ICommandList* commandList,
+		nvrhi::GraphicsPipelineHandle& pso,
+		nvrhi::IBindingLayout* viewBindingLayout,
+		nvrhi::IBindingSet* viewBindingSet,
+		nvrhi::IFramebuffer* framebuffer,
+		nvrhi::IShader* vs,
+		nvrhi::IShader* ps
+	)
+	{
+		CORE_PROFILE_SCOPE_NC("Tiny2D::MeshWireframePass::End", RENDERING_COLOR);
+
+		if (draws.empty())
+			return;
+
+		if (!pso)
+		{
+			nvrhi::GraphicsPipelineDesc psoDesc;
 			psoDesc.VS = vs;
 			psoDesc.PS = ps;
-			psoDesc.GS = gs ? gs : psoDesc.GS.Get();
-			psoDesc.inputLayout = inputLayout;
-			psoDesc.bindingLayouts = bindingLayouts;
-			psoDesc.primType = primType;
+			psoDesc.bindingLayouts = { viewBindingLayout, bindingLayout };
+			psoDesc.primType = nvrhi::PrimitiveType::TriangleList;
 			psoDesc.renderState = {
 				.blendState = {
 					.alphaToCoverageEnable = true,
 				},
 				.depthStencilState = {
-					.depthTestEnable = true,
+					.depthTestEnable = true
 				},
 				.rasterState = {
 					.cullMode = nvrhi::RasterCullMode::None,
@@ -850,54 +2382,24 @@ struct InstancedPass
 				},
 			};
 
-			for (uint32_t i = 0; i < fb->getDesc().colorAttachments.size(); i++)
-			{
-				nvrhi::Format format = fb->getDesc().colorAttachments[i].texture->getDesc().format;
-				nvrhi::FormatInfo formatInfo = nvrhi::getFormatInfo(format);
-
-				if (formatInfo.hasAlpha)
-				{
-					psoDesc.renderState.blendState.targets[i] = {
-						.blendEnable = true,
-						.srcBlend = nvrhi::BlendFactor::SrcAlpha,
-						.destBlend = nvrhi::BlendFactor::InvSrcAlpha,
-						.blendOp = nvrhi::BlendOp::Add,
-						.srcBlendAlpha = nvrhi::BlendFactor::One,
-						.destBlendAlpha = nvrhi::BlendFactor::One,
-						.blendOpAlpha = nvrhi::BlendOp::Add,
-						.colorWriteMask = nvrhi::ColorMask::All,
-					};
-				}
-			}
-
-			pso = device->createGraphicsPipeline(psoDesc, fb);
+			pso = device->createGraphicsPipeline(psoDesc, framebuffer);
 			CORE_ASSERT(pso);
 		}
 
-		// draw
-		{
-			CORE_PROFILE_SCOPE_NC("Tiny2D::InstancedPass::draw", RENDERING_COLOR);
-
-			if (instanceCount <= 0)
-				return;
-
-			nvrhi::GraphicsState state;
-			state.pipeline = pso;
-			state.framebuffer = fb;
-			state.viewport.addViewportAndScissorRect(fb->getFramebufferInfo().getViewport());
+		nvrhi::GraphicsState state;
+		state.pipeline = pso;
+		state.framebuffer = framebuffer;
+		state.viewport.addViewportAndScissorRect(framebuffer->getFramebufferInfo().getViewport());
 
-			commandList->beginMarker(typeid(T).name());
-			{
-				state.bindings = bindings;
-				state.vertexBuffers = T::GetVertexBuffers(instanceBuffer);
-				commandList->setGraphicsState(state);
-				commandList->draw({ 
-					.vertexCount = vertexCount, 
-					.instanceCount = instanceCount 
-				});
-			}
-			commandList->endMarker();
+		commandList->beginMarker("MeshWireframes");
+		for (const Draw& draw : draws)
+		{
+			state.bindings = { viewBindingSet, GetBindingSet(draw) };
+			commandList->setGraphicsState(state);
+			commandList->setPushConstants(&draw.constants, sizeof(MeshWireframeConstants));
+			commandList->draw({ .vertexCount = draw.triangleCount * 18 });
 		}
+		commandList->endMarker();
 	}
 };
 
@@ -911,26 +2413,238 @@ struct ViewBuffer
 	Math::float2 viewSize;
 };
 
-struct ViewData
+struct Tiny2D::DrawContext
 {
-	Framebuffer framebuffer;
-	nvrhi::BindingSetHandle bindingSet;
-	nvrhi::BufferHandle viewBuffer;
-
+	ViewData* view = nullptr;
+	Arena arena;
 	LinePass line;
 	InstancedPass<spriteAttributes> sprite;
 	InstancedPass<CircleAttributes> circle;
 	InstancedPass<TextAttributes> text;
 	InstancedPass<BoxAttributes> box;
+	InstancedPass<PackedSpriteAttributes> packedSprite;
+	InstancedPass<PackedCircleAttributes> packedCircle;
+	InstancedPass<PackedTextAttributes> packedText;
+	InstancedPass<PackedBoxAttributes> packedBox;
+	InstancedPass<Sprite2DAttributes> sprite2D;
+	InstancedPass<Circle2DAttributes> circle2D;
+	WirePass wire;
+	InstancedPass<AABBAttributes> aabb;
+	MeshWireframePass meshWireframe;
+	bool acquired = false;
+
+	void Begin(uint32_t frameIndex)
+	{
+		uint64_t expectedBytes =
+			line.vertices.ExpectedBytes() +
+			line.strips.ExpectedBytes() +
+			sprite.instances.ExpectedBytes() +
+			circle.instances.ExpectedBytes() +
+			text.instances.ExpectedBytes() +
+			box.instances.ExpectedBytes() +
+			packedSprite.instances.ExpectedBytes() +
+			packedCircle.instances.ExpectedBytes() +
+			packedText.instances.ExpectedBytes() +
+			packedBox.instances.ExpectedBytes() +
+			sprite2D.instances.ExpectedBytes() +
+			circle2D.instances.ExpectedBytes() +
+			wire.ExpectedBytes() +
+			aabb.instances.ExpectedBytes();
+
+		arena.Begin(frameIndex, expectedBytes);
+
+		line.Begin();
+		sprite.Begin();
+		circle.Begin();
+		text.Begin();
+		box.Begin();
+		packedSprite.Begin();
+		packedCircle.Begin();
+		packedText.Begin();
+		packedBox.Begin();
+		sprite2D.Begin();
+		circle2D.Begin();
+		wire.Begin();
+		aabb.Begin();
+		meshWireframe.Begin();
+	}
+
+	void Rewind()
+	{
+		arena.Rewind();
+
+		line.Rewind();
+		sprite.instances.Rewind();
+		circle.instances.Rewind();
+		text.instances.Rewind();
+		box.instances.Rewind();
+		packedSprite.instances.Rewind();
+		packedCircle.instances.Rewind();
+		packedText.instances.Rewind();
+		packedBox.instances.Rewind();
+		sprite2D.instances.Rewind();
+		circle2D.instances.Rewind();
+		wire.Rewind();
+		aabb.instances.Rewind();
+		meshWireframe.Rewind();
+	}
+
+	void Discard()
+	{
+		line.Discard();
+		sprite.instances.Discard();
+		circle.instances.Discard();
+		text.instances.Discard();
+		box.instances.Discard();
+		packedSprite.instances.Discard();
+		packedCircle.instances.Discard();
+		packedText.instances.Discard();
+		packedBox.instances.Discard();
+		sprite2D.instances.Discard();
+		circle2D.instances.Discard();
+		wire.Discard();
+		aabb.instances.Discard();
+
+		arena.Rewind();
+	}
+
+	void SetFramesInFlight(uint32_t framesInFlight)
+	{
+		arena.SetFramesInFlight(framesInFlight);
+	}
+
+	template<typename F>
+	void ForEachStream(F&& f)
+	{
+		f(line.vertices);
+		f(line.strips);
+		f(sprite.instances);
+		f(circle.instances);
+		f(text.instances);
+		f(box.instances);
+		f(packedSprite.instances);
+		f(packedCircle.instances);
+		f(packedText.instances);
+		f(packedBox.instances);
+		f(sprite2D.instances);
+		f(circle2D.instances);
+		wire.ForEachStream(f);
+		f(aabb.instances);
+	}
+
+	// applied before Begin, so the arena of this frame is allocated at the hinted size up front
+	// only the passes InitDesc::packedInstances selects are drawn into, a hint on the others would reserve bytes never used
+	void SetCapacityHints(const Tiny2D::ViewDesc& desc, bool packedInstances)
+	{
+		line.vertices.capacityHint = desc.lineCapacity * 2;
+		sprite.instances.capacityHint = packedInstances ? 0 : desc.spriteCapacity;
+		circle.instances.capacityHint = packedInstances ? 0 : desc.circleCapacity;
+		text.instances.capacityHint = packedInstances ? 0 : desc.textCapacity;
+		box.instances.capacityHint = packedInstances ? 0 : desc.boxCapacity;
+		packedSprite.instances.capacityHint = packedInstances ? desc.spriteCapacity : 0;
+		packedCircle.instances.capacityHint = packedInstances ? desc.circleCapacity : 0;
+		packedText.instances.capacityHint = packedInstances ? desc.textCapacity : 0;
+		packedBox.instances.capacityHint = packedInstances ? desc.boxCapacity : 0;
+	}
+};
+
+struct ViewPipelines
+{
+	nvrhi::GraphicsPipelineHandle line;
+	nvrhi::GraphicsPipelineHandle lineStrip;
+	nvrhi::GraphicsPipelineHandle sprite;
+	nvrhi::GraphicsPipelineHandle circle;
+	nvrhi::GraphicsPipelineHandle text;
+	nvrhi::GraphicsPipelineHandle box;
+	nvrhi::GraphicsPipelineHandle sprite2D;
+	nvrhi::GraphicsPipelineHandle circle2D;
+	nvrhi::GraphicsPipelineHandle wire;
+	nvrhi::GraphicsPipelineHandle aabb;
+	nvrhi::GraphicsPipelineHandle meshWireframe;
+
+	void Reset()
+	{
+		line.Reset();
+		lineStrip.Reset();
+		sprite.Reset();
+		circle.Reset();
+		text.Reset();
+		box.Reset();
+		sprite2D.Reset();
+		circle2D.Reset();
+		wire.Reset();
+		aabb.Reset();
+		meshWireframe.Reset();
+	}
+};
+
+struct FrameFence
+{
+	nvrhi::EventQueryHandle query;
+	uint64_t frame = 0;
+	bool pending = false;
+};
+
+// Draws recorded once by CreateStaticBatch, the batches of its context point into one device-local buffer
+struct StaticBatch
+{
+	std::unique_ptr<Tiny2D::DrawContext> context;
+	nvrhi::BufferHandle buffer;
+
+	// the upload buffers the copies read from, released through the first view that draws the batch
+	DeferredReleaseQueue staging;
+	std::once_flag stagingReleased;
+	MemoryBudget budget;
+};
+
+struct StaticDraw
+{
+	Tiny2D::StaticBatchHandle batch;
+	Math::float4x4 transform;
+};
+
+struct ViewData
+{
+	Framebuffer framebuffer;
+	nvrhi::BindingSetHandle bindingSet;
+	nvrhi::BindingSetHandle lineBindingSet;
+	nvrhi::BufferHandle viewBuffer;
+	ViewBuffer viewConstants;
+	ViewPipelines pipelines;
+	nvrhi::ICommandList* commandList = nullptr;
+	std::function<void(nvrhi::ICommandList*)> submit;
+
+	// contexts[0] belongs to the thread that called BeginScene, the rest are handed out by AcquireDrawContext.
+	// AcquireDrawContext may grow the vector while the scene is recorded, so the owning thread goes through primaryContext
+	std::vector<std::unique_ptr<Tiny2D::DrawContext>> contexts;
+	Tiny2D::DrawContext* primaryContext = nullptr;
+	uint32_t activeContextCount = 0;
+	std::mutex contextMutex;
+	MemoryBudget budget;
+	float wireTolerance = 0.0f;
+
+	// drawn after the contexts in EndScene
+	std::vector<StaticDraw> staticDraws;
+
+	// signaled once the command list of the corresponding frame slot has been consumed by the GPU
+	std::vector<FrameFence> frames;
+	uint32_t frameIndex = 0;
+	uint64_t frameNumber = 0;
+	uint64_t completedFrame = 0;
+	DeferredReleaseQueue releaseQueue;
+
 	Tiny2D::Stats stats;
 };
 
 struct RendererData
 {
 	nvrhi::IDevice* device;
-	nvrhi::ICommandList* commandList;
+	bool packedInstances = false;
+	Tiny2D::LineMode lineMode = Tiny2D::LineMode::GeometryShader;
 	
 	nvrhi::BindingLayoutHandle bindingLayout;
+	nvrhi::BindingLayoutHandle lineBindingLayout;
+	nvrhi::BindingLayoutHandle meshWireframeBindingLayout;
 	nvrhi::BindingLayoutHandle bindlessLayout;
 	nvrhi::SamplerHandle sampler;
 	DescriptorTableManager descriptorTableManager;
@@ -953,13 +2667,221 @@ struct RendererData
 	nvrhi::ShaderHandle boxVertexShader;
 	nvrhi::ShaderHandle boxPixelShader;
 
+	nvrhi::ShaderHandle sprite2DVertexShader;
+	nvrhi::ShaderHandle circle2DVertexShader;
+
+	nvrhi::ShaderHandle wireVertexShader;
+	nvrhi::ShaderHandle wirePixelShader;
+	nvrhi::ShaderHandle aabbVertexShader;
+	nvrhi::ShaderHandle meshWireframeVertexShader;
+
 	Ref<Font> defaultFont;
-	ViewData* fd;
+
+	// unique edges of the meshes drawn with a wireframe key, pairs of vertex indices.
+	// Shared so a draw keeps reading its edges while another thread rebuilds or releases the entry
+	struct WireframeEdges
+	{
+		size_t indexCount = 0;
+		std::shared_ptr<const std::vector<uint32_t>> edges;
+	};
+
+	std::unordered_map<uint64_t, WireframeEdges> wireframes;
+	std::shared_mutex wireframeMutex;
 };
 
 static RendererData* s_Data = nullptr;
+static thread_local ViewData* t_View = nullptr;
+static thread_local Tiny2D::DrawContext* t_DrawContext = nullptr;
+
+// viewData is null for the context of a static batch
+static std::unique_ptr<Tiny2D::DrawContext> CreateDrawContext(ViewData* viewData, DeferredReleaseQueue* releaseQueue, MemoryBudget* budget, uint32_t framesInFlight)
+{
+	auto context = std::make_unique<Tiny2D::DrawContext>();
+	Arena* arena = &context->arena;
+
+	context->view = viewData;
+	context->arena.Init(s_Data->device, releaseQueue, budget, context.get(), framesInFlight);
+	context->line.Init(s_Data->device, arena, s_Data->lineVertexShader, s_Data->lineMode);
+
+	// the passes of the other layout stay empty
+	if (s_Data->packedInstances)
+	{
+		context->packedSprite.Init(s_Data->device, arena, s_Data->spriteVertexShader);
+		context->packedCircle.Init(s_Data->device, arena, s_Data->circleVertexShader);
+		context->packedText.Init(s_Data->device, arena, s_Data->textVertexShader);
+		context->packedBox.Init(s_Data->device, arena, s_Data->boxVertexShader);
+	}
+	else
+	{
+		context->sprite.Init(s_Data->device, arena, s_Data->spriteVertexShader);
+		context->circle.Init(s_Data->device, arena, s_Data->circleVertexShader);
+		context->text.Init(s_Data->device, arena, s_Data->textVertexShader);
+		context->box.Init(s_Data->device, arena, s_Data->boxVertexShader);
+	}
+
+	context->sprite2D.Init(s_Data->device, arena, s_Data->sprite2DVertexShader);
+	context->circle2D.Init(s_Data->device, arena, s_Data->circle2DVertexShader);
+	context->wire.Init(s_Data->device, arena, s_Data->wireVertexShader);
+	context->aabb.Init(s_Data->device, arena, s_Data->aabbVertexShader);
+	context->meshWireframe.Init(s_Data->device, releaseQueue, s_Data->meshWireframeBindingLayout);
+
+	return context;
+}
+
+static void AdvanceFrame(ViewData* viewData, uint32_t framesInFlight)
+{
+	CORE_PROFILE_SCOPE_NC("Tiny2D::AdvanceFrame", RENDERING_COLOR);
+
+	nvrhi::IDevice* device = s_Data->device;
+	framesInFlight = Math::max(framesInFlight, 1u);
+
+	// the command list of the previous frame has been submitted by now, everything queued so far includes it
+	if (!viewData->frames.empty())
+	{
+		FrameFence& previous = viewData->frames[viewData->frameIndex];
+		device->resetEventQuery(previous.query);
+		device->setEventQuery(previous.query, nvrhi::CommandQueue::Graphics);
+		previous.frame = viewData->frameNumber;
+		previous.pending = true;
+	}
+
+	viewData->frameNumber++;
+
+	if (viewData->frames.size() != framesInFlight)
+	{
+		for (FrameFence& frame : viewData->frames)
+		{
+			if (frame.pending)
+				device->waitEventQuery(frame.query);
+		}
 
-void Tiny2D::Init(nvrhi::IDevice* device)
+		viewData->frames.clear();
+		viewData->frames.resize(framesInFlight);
+		for (FrameFence& frame : viewData->frames)
+			frame.query = device->createEventQuery();
+
+		for (auto& context : viewData->contexts)
+			context->SetFramesInFlight(framesInFlight);
+
+		viewData->frameIndex = 0;
+		viewData->completedFrame = viewData->frameNumber - 1;
+		viewData->releaseQueue.BeginFrame(viewData->frameNumber, viewData->completedFrame);
+		return;
+	}
+
+	viewData->frameIndex = (viewData->frameIndex + 1) % framesInFlight;
+
+	// only blocks when the CPU is more than framesInFlight frames ahead of the GPU
+	FrameFence& frame = viewData->frames[viewData->frameIndex];
+	if (frame.pending)
+	{
+		device->waitEventQuery(frame.query);
+		frame.pending = false;
+		viewData->completedFrame = Math::max(viewData->completedFrame, frame.frame);
+	}
+
+	for (FrameFence& other : viewData->frames)
+	{
+		if (other.pending && device->pollEventQuery(other.query))
+		{
+			other.pending = false;
+			viewData->completedFrame = Math::max(viewData->completedFrame, other.frame);
+		}
+	}
+
+	viewData->releaseQueue.BeginFrame(viewData->frameNumber, viewData->completedFrame);
+}
+
+static Tiny2D::DrawContext* GetDrawContext()
+{
+	CORE_ASSERT(t_DrawContext || t_View, "[Tiny2D] : Draw* called outside of BeginScene/EndScene and without a DrawContext");
+
+	return t_DrawContext ? t_DrawContext : t_View->primaryContext;
+}
+
+static void RenderDrawContext(ViewData* viewData, Tiny2D::DrawContext* context)
+{
+	context->line.End(
+		viewData->commandList,
+		viewData->pipelines.line,
+		viewData->pipelines.lineStrip,
+		s_Data->lineBindingLayout,
+		viewData->lineBindingSet,
+		viewData->framebuffer,
+		s_Data->lineVertexShader,
+		s_Data->linePixelShader,
+		s_Data->lineGeoShader
+	);
+
+	// only one of each plain and packed pass holds instances, so they can share the pipeline
+	nvrhi::BindingLayoutVector layouts = { s_Data->bindingLayout };
+	nvrhi::BindingSetVector bindings = { viewData->bindingSet };
+	nvrhi::BindingLayoutVector texturedLayouts = { s_Data->bindingLayout, s_Data->bindlessLayout };
+	auto descriptorTableLock = s_Data->descriptorTableManager.LockShared();
+	nvrhi::BindingSetVector texturedBindings = { viewData->bindingSet, s_Data->descriptorTableManager.descriptorTable.Get() };
+
+	context->sprite.End(viewData->commandList, viewData->pipelines.sprite, texturedLayouts, texturedBindings, viewData->framebuffer, s_Data->spriteVertexShader, s_Data->spritePixelShader, nullptr, 4, nvrhi::PrimitiveType::TriangleStrip);
+	context->packedSprite.End(viewData->commandList, viewData->pipelines.sprite, texturedLayouts, texturedBindings, viewData->framebuffer, s_Data->spriteVertexShader, s_Data->spritePixelShader, nullptr, 4, nvrhi::PrimitiveType::TriangleStrip);
+
+	context->circle.End(viewData->commandList, viewData->pipelines.circle, layouts, bindings, viewData->framebuffer, s_Data->circleVertexShader, s_Data->circlePixelShader, nullptr, 4, nvrhi::PrimitiveType::TriangleStrip);
+	context->packedCircle.End(viewData->commandList, viewData->pipelines.circle, layouts, bindings, viewData->framebuffer, s_Data->circleVertexShader, s_Data->circlePixelShader, nullptr, 4, nvrhi::PrimitiveType::TriangleStrip);
+
+	context->text.End(viewData->commandList, viewData->pipelines.text, texturedLayouts, texturedBindings, viewData->framebuffer, s_Data->textVertexShader, s_Data->textPixelShader, nullptr, 4, nvrhi::PrimitiveType::TriangleStrip);
+	context->packedText.End(viewData->commandList, viewData->pipelines.text, texturedLayouts, texturedBindings, viewData->framebuffer, s_Data->textVertexShader, s_Data->textPixelShader, nullptr, 4, nvrhi::PrimitiveType::TriangleStrip);
+
+	context->box.End(viewData->commandList, viewData->pipelines.box, layouts, bindings, viewData->framebuffer, s_Data->boxVertexShader, s_Data->boxPixelShader, nullptr, 14, nvrhi::PrimitiveType::TriangleStrip);
+	context->packedBox.End(viewData->commandList, viewData->pipelines.box, layouts, bindings, viewData->framebuffer, s_Data->boxVertexShader, s_Data->boxPixelShader, nullptr, 14, nvrhi::PrimitiveType::TriangleStrip);
+
+	context->sprite2D.End(viewData->commandList, viewData->pipelines.sprite2D, texturedLayouts, texturedBindings, viewData->framebuffer, s_Data->sprite2DVertexShader, s_Data->spritePixelShader, nullptr, 4, nvrhi::PrimitiveType::TriangleStrip);
+	context->circle2D.End(viewData->commandList, viewData->pipelines.circle2D, layouts, bindings, viewData->framebuffer, s_Data->circle2DVertexShader, s_Data->circlePixelShader, nullptr, 4, nvrhi::PrimitiveType::TriangleStrip);
+
+	context->wire.End(viewData->commandList, viewData->pipelines.wire, layouts, bindings, viewData->framebuffer, s_Data->wireVertexShader, s_Data->wirePixelShader);
+	context->aabb.End(viewData->commandList, viewData->pipelines.aabb, layouts, bindings, viewData->framebuffer, s_Data->aabbVertexShader, s_Data->wirePixelShader, nullptr, 12 * 6);
+	context->meshWireframe.End(viewData->commandList, viewData->pipelines.meshWireframe, s_Data->bindingLayout, viewData->bindingSet, viewData->framebuffer, s_Data->meshWireframeVertexShader, s_Data->wirePixelShader);
+}
+
+static bool FlushDrawContext(Tiny2D::DrawContext* context)
+{
+	ViewData* viewData = context->view;
+
+	// only the thread that called BeginScene may record into the command list, and only the caller can submit it
+	if (!viewData || !viewData->submit || t_View != viewData || context != viewData->primaryContext)
+		return false;
+
+	CORE_PROFILE_SCOPE_NC("Tiny2D::FlushDrawContext", RENDERING_COLOR);
+
+	RenderDrawContext(viewData, context);
+
+	nvrhi::ICommandList* commandList = viewData->commandList;
+	viewData->submit(commandList);
+
+	// volatile constants do not carry over to the reopened command list
+	commandList->writeBuffer(viewData->viewBuffer, &viewData->viewConstants, sizeof(ViewBuffer));
+
+	context->arena.Flush();
+	context->Rewind();
+
+	return true;
+}
+
+static bool OverflowDrawContext(Tiny2D::DrawContext* context)
+{
+	switch (context->arena.budget->policy)
+	{
+	case Tiny2D::OverflowPolicy::Flush:
+		return FlushDrawContext(context);
+
+	case Tiny2D::OverflowPolicy::DropAll:
+		context->Discard();
+		return true;
+
+	case Tiny2D::OverflowPolicy::DropNew:
+	default:
+		return false;
+	}
+}
+
+void Tiny2D::Init(nvrhi::IDevice* device, const InitDesc& initDesc)
 {
 	CORE_PROFILE_SCOPE_NC("Tiny2D::Init", RENDERING_COLOR);
 
@@ -967,6 +2889,8 @@ void Tiny2D::Init(nvrhi::IDevice* device)
 
 	s_Data = new RendererData();
 	s_Data->device = device;
+	s_Data->packedInstances = initDesc.packedInstances;
+	s_Data->lineMode = initDesc.lineMode;
 
 	{
 		nvrhi::ShaderDesc vsDesc;
@@ -985,18 +2909,70 @@ void Tiny2D::Init(nvrhi::IDevice* device)
 			vsDesc.debugName = "line_vs";
 			psDesc.debugName = "line_ps";
 			gsDesc.debugName = "line_gs";
-			s_Data->lineVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(line_main_vs), nullptr, vsDesc);
 			s_Data->linePixelShader = RHI::CreateStaticShader(device, STATIC_SHADER(line_main_ps), nullptr, psDesc);
-			s_Data->lineGeoShader = RHI::CreateStaticShader(device, STATIC_SHADER(line_main_gs), nullptr, gsDesc);
-			CORE_ASSERT(s_Data->lineVertexShader);
 			CORE_ASSERT(s_Data->linePixelShader);
-			CORE_ASSERT(s_Data->lineGeoShader);
+
+			if (initDesc.lineMode == LineMode::Instanced)
+			{
+				nvrhi::ShaderDesc instancedDesc = vsDesc;
+				instancedDesc.entryName = "main_vs_instanced";
+				s_Data->lineVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(line_main_vs_instanced), nullptr, instancedDesc);
+				CORE_ASSERT(s_Data->lineVertexShader);
+			}
+			else
+			{
+				s_Data->lineVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(line_main_vs), nullptr, vsDesc);
+				s_Data->lineGeoShader = RHI::CreateStaticShader(device, STATIC_SHADER(line_main_gs), nullptr, gsDesc);
+				CORE_ASSERT(s_Data->lineVertexShader);
+				CORE_ASSERT(s_Data->lineGeoShader);
+			}
+		}
+
+		{
+			vsDesc.debugName = "wire_vs";
+			psDesc.debugName = "wire_ps";
+			s_Data->wireVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(wire_main_vs), nullptr, vsDesc);
+			s_Data->wirePixelShader = RHI::CreateStaticShader(device, STATIC_SHADER(wire_main_ps), nullptr, psDesc);
+			CORE_ASSERT(s_Data->wireVertexShader);
+			CORE_ASSERT(s_Data->wirePixelShader);
+
+			nvrhi::ShaderDesc aabbDesc = vsDesc;
+			aabbDesc.entryName = "main_vs_aabb";
+			aabbDesc.debugName = "aabb_vs";
+			s_Data->aabbVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(wire_main_vs_aabb), nullptr, aabbDesc);
+			CORE_ASSERT(s_Data->aabbVertexShader);
+
+			nvrhi::ShaderDesc meshDesc = vsDesc;
+			meshDesc.entryName = "main_vs_mesh";
+			meshDesc.debugName = "mesh_wireframe_vs";
+			s_Data->meshWireframeVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(wire_main_vs_mesh), nullptr, meshDesc);
+			CORE_ASSERT(s_Data->meshWireframeVertexShader);
+		}
+
+		// the 2D instances have a single layout, created whatever packedInstances says
+		{
+			nvrhi::ShaderDesc desc2D = vsDesc;
+			desc2D.entryName = "main_vs_2d";
+
+			desc2D.debugName = "sprite_2d_vs";
+			s_Data->sprite2DVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(sprite_main_vs_2d), nullptr, desc2D);
+			CORE_ASSERT(s_Data->sprite2DVertexShader);
+
+			desc2D.debugName = "circle_2d_vs";
+			s_Data->circle2DVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(circle_main_vs_2d), nullptr, desc2D);
+			CORE_ASSERT(s_Data->circle2DVertexShader);
 		}
 
+		if (initDesc.packedInstances)
+			vsDesc.entryName = "main_vs_packed";
+
 		{
 			vsDesc.debugName = "sprite_vs";
 			psDesc.debugName = "sprite_ps";
-			s_Data->spriteVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(sprite_main_vs), nullptr, vsDesc);
+			if (initDesc.packedInstances)
+				s_Data->spriteVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(sprite_main_vs_packed), nullptr, vsDesc);
+			else
+				s_Data->spriteVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(sprite_main_vs), nullptr, vsDesc);
 			s_Data->spritePixelShader = RHI::CreateStaticShader(device, STATIC_SHADER(sprite_main_ps), nullptr, psDesc);
 			CORE_ASSERT(s_Data->spriteVertexShader);
 			CORE_ASSERT(s_Data->spritePixelShader);
@@ -1005,7 +2981,10 @@ void Tiny2D::Init(nvrhi::IDevice* device)
 		{
 			vsDesc.debugName = "circle_vs";
 			psDesc.debugName = "circle_ps";
-			s_Data->circleVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(circle_main_vs), nullptr, vsDesc);
+			if (initDesc.packedInstances)
+				s_Data->circleVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(circle_main_vs_packed), nullptr, vsDesc);
+			else
+				s_Data->circleVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(circle_main_vs), nullptr, vsDesc);
 			s_Data->circlePixelShader = RHI::CreateStaticShader(device, STATIC_SHADER(circle_main_ps), nullptr, psDesc);
 			CORE_ASSERT(s_Data->circleVertexShader);
 			CORE_ASSERT(s_Data->circlePixelShader);
@@ -1014,7 +2993,10 @@ void Tiny2D::Init(nvrhi::IDevice* device)
 		{
 			vsDesc.debugName = "text_vs";
 			psDesc.debugName = "text_ps";
-			s_Data->textVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(text_main_vs), nullptr, vsDesc);
+			if (initDesc.packedInstances)
+				s_Data->textVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(text_main_vs_packed), nullptr, vsDesc);
+			else
+				s_Data->textVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(text_main_vs), nullptr, vsDesc);
 			s_Data->textPixelShader = RHI::CreateStaticShader(device, STATIC_SHADER(text_main_ps), nullptr, psDesc);
 			CORE_ASSERT(s_Data->textVertexShader);
 			CORE_ASSERT(s_Data->textPixelShader);
@@ -1023,7 +3005,10 @@ void Tiny2D::Init(nvrhi::IDevice* device)
 		{
 			vsDesc.debugName = "box_vs";
 			psDesc.debugName = "box_ps";
-			s_Data->boxVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(box_main_vs), nullptr, vsDesc);
+			if (initDesc.packedInstances)
+				s_Data->boxVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(box_main_vs_packed), nullptr, vsDesc);
+			else
+				s_Data->boxVertexShader = RHI::CreateStaticShader(device, STATIC_SHADER(box_main_vs), nullptr, vsDesc);
 			s_Data->boxPixelShader = RHI::CreateStaticShader(device, STATIC_SHADER(box_main_ps), nullptr, psDesc);
 			CORE_ASSERT(s_Data->boxVertexShader);
 			CORE_ASSERT(s_Data->boxPixelShader);
@@ -1039,7 +3024,7 @@ void Tiny2D::Init(nvrhi::IDevice* device)
 			nvrhi::BindingLayoutItem::Texture_SRV(1)
 		};
 		s_Data->bindlessLayout = device->createBindlessLayout(bindlessLayoutDesc);
-		s_Data->descriptorTableManager.Init(device, s_Data->bindlessLayout);
+		s_Data->descriptorTableManager.Init(device, s_Data->bindlessLayout, bindlessLayoutDesc.maxCapacity);
 	}
 
 	{
@@ -1064,6 +3049,30 @@ void Tiny2D::Init(nvrhi::IDevice* device)
 		CORE_VERIFY(s_Data->bindingLayout);
 	}
 
+	{
+		nvrhi::BindingLayoutDesc desc;
+		desc.visibility = nvrhi::ShaderType::All;
+		desc.bindings = {
+			nvrhi::BindingLayoutItem::VolatileConstantBuffer(0),
+			nvrhi::BindingLayoutItem::PushConstants(1, sizeof(float))
+		};
+		s_Data->lineBindingLayout = s_Data->device->createBindingLayout(desc);
+		CORE_VERIFY(s_Data->lineBindingLayout);
+	}
+
+	{
+		nvrhi::BindingLayoutDesc desc;
+		desc.visibility = nvrhi::ShaderType::All;
+		desc.registerSpace = 1;
+		desc.bindings = {
+			nvrhi::BindingLayoutItem::PushConstants(1, sizeof(MeshWireframeConstants)),
+			nvrhi::BindingLayoutItem::RawBuffer_SRV(0),
+			nvrhi::BindingLayoutItem::RawBuffer_SRV(1),
+		};
+		s_Data->meshWireframeBindingLayout = s_Data->device->createBindingLayout(desc);
+		CORE_VERIFY(s_Data->meshWireframeBindingLayout);
+	}
+
 	{
 		nvrhi::CommandListHandle cl = device->createCommandList();
 		cl->open();
@@ -1107,24 +3116,23 @@ void Tiny2D::Shutdown()
 void Tiny2D::BeginScene(Tiny2D::ViewHandle& viewHandle, nvrhi::ICommandList* commandList, const ViewDesc& desc)
 {
 	CORE_PROFILE_SCOPE_NC("Tiny2D::BeginScene", RENDERING_COLOR);
-
-	s_Data->commandList = commandList;
+	CORE_ASSERT(!t_View, "[Tiny2D] : EndScene must be called before beginning another scene on the same thread");
 	
 	if(!viewHandle)
 	{
 		auto viewData = new ViewData();
 		viewHandle = Core::Ref<ViewData>(viewData);
 
-		viewData->line.Init(s_Data->device, s_Data->lineVertexShader);
-		viewData->sprite.Init(s_Data->device, s_Data->spriteVertexShader);
-		viewData->circle.Init(s_Data->device, s_Data->circleVertexShader);
-		viewData->text.Init(s_Data->device, s_Data->textVertexShader);
-		viewData->box.Init(s_Data->device, s_Data->boxVertexShader);
+		viewData->contexts.push_back(CreateDrawContext(viewData, &viewData->releaseQueue, &viewData->budget, desc.framesInFlight));
+		viewData->primaryContext = viewData->contexts[0].get();
 	}
 
 	ViewData* viewData = (ViewData*)viewHandle.get();
+	viewData->commandList = commandList;
 
-	s_Data->fd = viewData;
+	t_View = viewData;
+
+	AdvanceFrame(viewData, desc.framesInFlight);
 
 	if (!viewData->viewBuffer)
 	{
@@ -1132,6 +3140,30 @@ void Tiny2D::BeginScene(Tiny2D::ViewHandle& viewHandle, nvrhi::ICommandList* com
 		CORE_VERIFY(viewData->viewBuffer);
 	}
 
+	if (!viewData->bindingSet)
+	{
+		nvrhi::BindingSetDesc bindingSetDesc;
+		bindingSetDesc.bindings = {
+			nvrhi::BindingSetItem::ConstantBuffer(0, viewData->viewBuffer),
+			nvrhi::BindingSetItem::Sampler(0, s_Data->sampler)
+		};
+
+		viewData->bindingSet = s_Data->device->createBindingSet(bindingSetDesc, s_Data->bindingLayout);
+		CORE_VERIFY(viewData->bindingSet);
+	}
+
+	if (!viewData->lineBindingSet)
+	{
+		nvrhi::BindingSetDesc bindingSetDesc;
+		bindingSetDesc.bindings = {
+			nvrhi::BindingSetItem::ConstantBuffer(0, viewData->viewBuffer),
+			nvrhi::BindingSetItem::PushConstants(1, sizeof(float))
+		};
+
+		viewData->lineBindingSet = s_Data->device->createBindingSet(bindingSetDesc, s_Data->lineBindingLayout);
+		CORE_VERIFY(viewData->lineBindingSet);
+	}
+
 	if (!viewData->framebuffer)
 	{
 		viewData->framebuffer.Init(s_Data->device, { desc.viewSize.x, desc.viewSize.y }, desc.renderTargetColorFormat, desc.sampleCount);
@@ -1141,103 +3173,95 @@ void Tiny2D::BeginScene(Tiny2D::ViewHandle& viewHandle, nvrhi::ICommandList* com
 	const auto& rt = viewData->framebuffer.color->getDesc();
 	if (rt.width != desc.viewSize.x || rt.height != desc.viewSize.y)
 	{
-		viewData->line.pso.Reset();
-		viewData->sprite.pso.Reset();
-		viewData->circle.pso.Reset();
-		viewData->text.pso.Reset();
-		viewData->box.pso.Reset();
+		viewData->pipelines.Reset();
 
+		viewData->framebuffer.Retire(viewData->releaseQueue);
 		viewData->framebuffer.Init(s_Data->device, { desc.viewSize.x, desc.viewSize.y }, desc.renderTargetColorFormat, desc.sampleCount);
 	}
 
 	viewData->framebuffer.Clear(commandList);
 
 	{
-		ViewBuffer viewBuffer = {};
-		viewBuffer.ViewProjMatrix = desc.viewProj;
-		viewBuffer.viewSize = desc.viewSize;
-		commandList->writeBuffer(viewData->viewBuffer, &viewBuffer, sizeof(ViewBuffer));
+		viewData->viewConstants = {};
+		viewData->viewConstants.ViewProjMatrix = desc.viewProj;
+		viewData->viewConstants.viewSize = desc.viewSize;
+		commandList->writeBuffer(viewData->viewBuffer, &viewData->viewConstants, sizeof(ViewBuffer));
 	}
 
 	{
-		viewData->stats.quadCount = viewData->sprite.instanceCount + viewData->circle.instanceCount + viewData->text.instanceCount;
-		viewData->stats.boxCount = viewData->box.instanceCount;
-		viewData->stats.LineCount = viewData->line.vertexCount / 2;
+		viewData->stats = {};
+		for (uint32_t i = 0; i < viewData->activeContextCount; i++)
+		{
+			const Tiny2D::DrawContext* context = viewData->contexts[i].get();
+
+			viewData->stats.quadCount += context->sprite.instances.count + context->circle.instances.count + context->text.instances.count;
+			viewData->stats.quadCount += context->packedSprite.instances.count + context->packedCircle.instances.count + context->packedText.instances.count;
+			viewData->stats.quadCount += context->sprite2D.instances.count + context->circle2D.instances.count;
+			viewData->stats.boxCount += context->box.instances.count + context->packedBox.instances.count;
+			viewData->stats.LineCount += context->line.vertices.count / 2 + context->line.stripSegments + context->wire.SegmentCount() + context->aabb.instances.count * 12 + context->meshWireframe.edgeCount;
+
+			viewData->stats.droppedQuads += context->sprite.instances.dropped + context->circle.instances.dropped + context->text.instances.dropped;
+			viewData->stats.droppedQuads += context->packedSprite.instances.dropped + context->packedCircle.instances.dropped + context->packedText.instances.dropped;
+			viewData->stats.droppedQuads += context->sprite2D.instances.dropped + context->circle2D.instances.dropped;
+			viewData->stats.droppedBoxes += context->box.instances.dropped + context->packedBox.instances.dropped;
+			viewData->stats.droppedLines += context->line.vertices.dropped / 2 + context->line.droppedStripSegments + context->wire.DroppedSegmentCount() + context->aabb.instances.dropped * 12;
+
+			viewData->stats.flushCount += context->arena.flushCount;
+			viewData->stats.flushBytes += context->arena.flushBytes;
+			viewData->stats.flushFallbacks += context->arena.flushFallbacks;
+		}
+
+		for (const auto& context : viewData->contexts)
+		{
+			viewData->stats.bufferCapacity += context->arena.AllocatedBytes();
+			viewData->stats.bufferPeak = Math::max(viewData->stats.bufferPeak, Math::max(context->arena.peakBytes, context->arena.usedBytes));
+			viewData->stats.bufferReallocations += context->arena.reallocations;
+		}
+
+		viewData->budget.limit = desc.memoryBudget;
+		viewData->budget.policy = desc.overflowPolicy;
+		viewData->budget.used = 0;
+
+		viewData->wireTolerance = desc.wireTolerance;
+		viewData->submit = desc.submit;
 
-		viewData->line.Begin();
-		viewData->sprite.Begin();
-		viewData->circle.Begin();
-		viewData->text.Begin();
-		viewData->box.Begin();
+		viewData->activeContextCount = 1;
+		viewData->primaryContext->SetCapacityHints(desc, s_Data->packedInstances);
+		viewData->primaryContext->Begin(viewData->frameIndex);
 	}
 }
 
 void Tiny2D::EndScene()
 {
 	CORE_PROFILE_SCOPE_NC("Tiny2D::EndScene", RENDERING_COLOR);
-	BUILTIN_PROFILE(s_Data->device, s_Data->commandList, "Tiny2D");
+	CORE_ASSERT(t_View, "[Tiny2D] : EndScene called without BeginScene");
 
-	ViewData* viewData = s_Data->fd;
+	ViewData* viewData = t_View;
+	BUILTIN_PROFILE(s_Data->device, viewData->commandList, "Tiny2D");
 
-	if(!viewData->bindingSet)
+	for (uint32_t i = 0; i < viewData->activeContextCount; i++)
 	{
-		nvrhi::BindingSetDesc desc;
-		desc.bindings = {
-			nvrhi::BindingSetItem::ConstantBuffer(0, viewData->viewBuffer),
-			nvrhi::BindingSetItem::Sampler(0, s_Data->sampler)
-		};
-
-		viewData->bindingSet = s_Data->device->createBindingSet(desc, s_Data->bindingLayout);
-		CORE_VERIFY(viewData->bindingSet);
-	}
-
-	viewData->line.End(
-		s_Data->commandList,
-		s_Data->bindingLayout,
-		viewData->bindingSet,
-		viewData->framebuffer,
-		s_Data->lineVertexShader,
-		s_Data->linePixelShader,
-		s_Data->lineGeoShader
-	);
+		Tiny2D::DrawContext* context = viewData->contexts[i].get();
+		CORE_ASSERT(!context->acquired, "[Tiny2D] : every DrawContext must be released before EndScene");
 
-	viewData->sprite.End(
-		s_Data->commandList,
-		{ s_Data->bindingLayout ,s_Data->bindlessLayout },
-		{ viewData->bindingSet, s_Data->descriptorTableManager.descriptorTable.Get() },
-		viewData->framebuffer,
-		s_Data->spriteVertexShader, s_Data->spritePixelShader, nullptr
-	);
-	
-	viewData->circle.End(
-		s_Data->commandList,
-		{ s_Data->bindingLayout },
-		{ viewData->bindingSet },
-		viewData->framebuffer,
-		s_Data->circleVertexShader, s_Data->circlePixelShader, nullptr
-	);
-	
-	viewData->text.End(
-		s_Data->commandList,
-		{ s_Data->bindingLayout ,s_Data->bindlessLayout },
-		{ viewData->bindingSet, s_Data->descriptorTableManager.descriptorTable.Get() },
-		viewData->framebuffer,
-		s_Data->textVertexShader, s_Data->textPixelShader, nullptr
-	);
-	
-	viewData->box.End(
-		s_Data->commandList,
-		{ s_Data->bindingLayout },
-		{ viewData->bindingSet },
-		viewData->framebuffer,
-		s_Data->boxVertexShader, s_Data->boxPixelShader, nullptr,
-		36
-	);
+		RenderDrawContext(viewData, context);
+	}
+
+	// the transform of each static batch is folded into the view constants, volatile buffers keep a version per draw
+	for (const StaticDraw& draw : viewData->staticDraws)
+	{
+		ViewBuffer constants = viewData->viewConstants;
+		constants.ViewProjMatrix = viewData->viewConstants.ViewProjMatrix * draw.transform;
+		viewData->commandList->writeBuffer(viewData->viewBuffer, &constants, sizeof(ViewBuffer));
+
+		RenderDrawContext(viewData, draw.batch->context.get());
+	}
+	viewData->staticDraws.clear();
 
 	if (viewData->framebuffer.color->getDesc().sampleCount > 1)
 	{
 		auto subresources = nvrhi::TextureSubresourceSet(0, 1, 0, 1);
-		s_Data->commandList->resolveTexture(
+		viewData->commandList->resolveTexture(
 			viewData->framebuffer.resolvedColor,
 			subresources,
 			viewData->framebuffer.color,
@@ -1245,8 +3269,8 @@ void Tiny2D::EndScene()
 		);
 	}
 
-	s_Data->fd = nullptr;
-	s_Data->commandList = nullptr;
+	viewData->commandList = nullptr;
+	t_View = nullptr;
 }
 
 nvrhi::ITexture* Tiny2D::GetColorTarget(ViewHandle viewHandle)
@@ -1278,16 +3302,120 @@ const Tiny2D::Stats& Tiny2D::GetStats(ViewHandle viewHandle)
 	return viewData->stats;
 }
 
-//////////////////////////////////////////////////////////////////////////
-// Draw
-//////////////////////////////////////////////////////////////////////////
+Tiny2D::DrawContext* Tiny2D::AcquireDrawContext(ViewHandle viewHandle)
+{
+	CORE_PROFILE_SCOPE_NC("Tiny2D::AcquireDrawContext", RENDERING_COLOR);
+	CORE_ASSERT(!t_DrawContext, "[Tiny2D] : this thread already holds a DrawContext");
+
+	ViewData* viewData = (ViewData*)viewHandle.get();
+
+	Tiny2D::DrawContext* context = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(viewData->contextMutex);
+
+		if (viewData->activeContextCount == viewData->contexts.size())
+			viewData->contexts.push_back(CreateDrawContext(viewData, &viewData->releaseQueue, &viewData->budget, (uint32_t)viewData->frames.size()));
+
+		context = viewData->contexts[viewData->activeContextCount++].get();
+	}
+
+	context->Begin(viewData->frameIndex);
+	context->acquired = true;
+	t_DrawContext = context;
+
+	return context;
+}
+
+void Tiny2D::ReleaseDrawContext(DrawContext* context)
+{
+	CORE_ASSERT(context && t_DrawContext == context, "[Tiny2D] : DrawContext must be released by the thread that acquired it");
+
+	context->acquired = false;
+	t_DrawContext = nullptr;
+}
+
+Tiny2D::StaticBatchHandle Tiny2D::CreateStaticBatch(nvrhi::ICommandList* commandList, const std::function<void()>& record)
+{
+	CORE_PROFILE_SCOPE_NC("Tiny2D::CreateStaticBatch", RENDERING_COLOR);
+	CORE_ASSERT(!t_DrawContext, "[Tiny2D] : CreateStaticBatch called while this thread holds a DrawContext");
+
+	auto batch = new StaticBatch();
+	StaticBatchHandle handle = Core::Ref<StaticBatch>(batch);
+
+	batch->context = CreateDrawContext(nullptr, &batch->staging, &batch->budget, 1);
+	batch->context->Begin(0);
+
+	t_DrawContext = batch->context.get();
+	record();
+	t_DrawContext = nullptr;
+
+	batch->context->meshWireframe.ResolveBindingSets();
+
+	uint64_t byteSize = 0;
+	batch->context->ForEachStream([&](auto& stream) {
+		for (const StreamBatch& b : stream.batches)
+			byteSize += Arena::Align(uint64_t(b.count) * sizeof(*stream.ptr));
+	});
+
+	if (byteSize == 0)
+		return handle;
 
-static Math::float3 Transform(const Math::float3& v, Math::float4x4 wt)
+	nvrhi::BufferDesc desc;
+	desc.byteSize = byteSize;
+	desc.isVertexBuffer = true;
+	desc.debugName = "Tiny2D-StaticBatch";
+	desc.initialState = nvrhi::ResourceStates::CopyDest;
+	batch->buffer = s_Data->device->createBuffer(desc);
+	CORE_VERIFY(batch->buffer);
+
+	commandList->beginTrackingBufferState(batch->buffer, nvrhi::ResourceStates::CopyDest);
+
+	// the batches are pointed at their copy, the context then renders from it like any other
+	uint64_t offset = 0;
+	batch->context->ForEachStream([&](auto& stream) {
+		for (StreamBatch& b : stream.batches)
+		{
+			uint64_t size = uint64_t(b.count) * sizeof(*stream.ptr);
+			if (size)
+				commandList->copyBuffer(batch->buffer, offset, b.buffer, b.offset, size);
+
+			b.buffer = batch->buffer;
+			b.offset = offset;
+			offset += Arena::Align(size);
+		}
+	});
+
+	commandList->setPermanentBufferState(batch->buffer, nvrhi::ResourceStates::VertexBuffer);
+	commandList->commitBarriers();
+
+	return handle;
+}
+
+void Tiny2D::DrawStaticBatch(StaticBatchHandle batchHandle, const Math::float4x4& transform)
 {
-	glm::vec4 t = wt * glm::vec4(v.x, v.y, v.z, 1.0f);
-	return Math::float3{ t.x, t.y, t.z };
+	CORE_ASSERT(t_View, "[Tiny2D] : DrawStaticBatch called outside of BeginScene/EndScene");
+
+	// a batch without a buffer may still hold mesh wireframes, which read the buffers of their meshes
+	StaticBatch* batch = batchHandle.get();
+	if (!batch)
+		return;
+
+	// the command list of CreateStaticBatch has been executed before this one, the fence of
+	// this frame covers the copies
+	std::call_once(batch->stagingReleased, [&]() {
+		for (UploadRegion& region : batch->context->arena.regions)
+			region.Retire(s_Data->device, t_View->releaseQueue);
+
+		batch->staging.MoveTo(t_View->releaseQueue);
+	});
+
+	t_View->staticDraws.push_back({ batchHandle, transform });
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Draw
+//////////////////////////////////////////////////////////////////////////
+
 Math::float4x4 ConstructTransformMatrix(const Math::vec3& position, const Math::quat& rotation, const Math::vec3& scale)
 {
 	Math::float3x3 rotationMatrix = Math::float3x3(rotation);
@@ -1309,36 +3437,109 @@ Math::float4x4 ConstructTransformMatrix(const Math::vec3& position, const Math::
 	return transformMatrix;
 }
 
-void Tiny2D::DrawLine(const LineDesc& desc)
+// writes to whichever of the two passes Init selected
+template<typename T, typename P, typename I>
+static void WriteInstance(InstancedPass<T>& pass, InstancedPass<P>& packedPass, const I& instance)
+{
+	if (s_Data->packedInstances)
+	{
+		if (P* attributes = packedPass.instances.Allocate(1))
+			*attributes = P::Pack(instance);
+	}
+	else if (T* attributes = pass.instances.Allocate(1))
+	{
+		*attributes = T::Pack(instance);
+	}
+}
+
+// writes count instances in chunks a memory budget can hold, write(instances, first, n) fills n of them
+template<typename T, typename F>
+static void WriteInstances(ArenaStream<T>& stream, size_t count, F&& write)
+{
+	constexpr size_t c_ChunkSize = 4096;
+
+	for (size_t first = 0; first < count; first += c_ChunkSize)
+	{
+		uint32_t n = (uint32_t)Math::min(c_ChunkSize, count - first);
+		if (T* instances = stream.Allocate(n))
+			write(instances, first, n);
+	}
+}
+
+// bulk WriteInstance, make(i) returns the *Instance of element i
+template<typename T, typename P, typename F>
+static void WriteInstances(InstancedPass<T>& pass, InstancedPass<P>& packedPass, size_t count, F&& make)
+{
+	if (s_Data->packedInstances)
+	{
+		WriteInstances(packedPass.instances, count, [&](P* instances, size_t first, uint32_t n) {
+			for (uint32_t i = 0; i < n; i++)
+				instances[i] = P::Pack(make(first + i));
+		});
+	}
+	else
+	{
+		WriteInstances(pass.instances, count, [&](T* instances, size_t first, uint32_t n) {
+			for (uint32_t i = 0; i < n; i++)
+				instances[i] = T::Pack(make(first + i));
+		});
+	}
+}
+
+// element i of an optional stream of QuadStreams or CircleStreams
+template<typename T>
+static const T& StreamElement(std::span<const T> stream, const T& uniform, size_t i)
 {
-	auto& lins = s_Data->fd->line;
+	return stream.empty() ? uniform : stream[i];
+}
 
-	if (lins.vertexCount >= lins.maxLinesCount * 2)
-		lins.ResizeBuffer();
+void Tiny2D::DrawLine(const LineDesc& desc)
+{
+	LinePass::LineVertex* vertices = GetDrawContext()->line.Allocate(2, desc.thickness);
+	if (!vertices)
+		return;
 
-	lins.vertexBufferPtr->position = desc.from;
-	lins.vertexBufferPtr->color = desc.fromColor;
-	lins.vertexBufferPtr->thickness = desc.thickness;
-	lins.vertexBufferPtr++;
-		  
-	lins.vertexBufferPtr->position = desc.to;
-	lins.vertexBufferPtr->color = desc.toColor;
-	lins.vertexBufferPtr->thickness = desc.thickness;
-	lins.vertexBufferPtr++;
+	vertices[0].position = desc.from;
+	vertices[0].color = PackColor(desc.fromColor);
 
-	lins.vertexCount += 2;
+	vertices[1].position = desc.to;
+	vertices[1].color = PackColor(desc.toColor);
 }
 
-void Tiny2D::DrawLineList(Math::float3* points, uint32_t size, const Math::float4& color, float thickness)
+void Tiny2D::DrawLines(std::span<const LineDesc> lines)
 {
-	CORE_ASSERT(points);
+	constexpr size_t c_ChunkSize = 4096;
+
+	LinePass& line = GetDrawContext()->line;
+
+	// one allocation per run of lines sharing a thickness, which is constant per batch
+	size_t first = 0;
+	while (first < lines.size())
+	{
+		float thickness = lines[first].thickness;
+
+		size_t last = first + 1;
+		while (last < lines.size() && last - first < c_ChunkSize && lines[last].thickness == thickness)
+			last++;
 
-	auto& lines = s_Data->fd->line;
+		uint32_t n = uint32_t(last - first);
+		if (LinePass::LineVertex* vertices = line.Allocate(n * 2, thickness))
+		{
+			for (uint32_t i = 0; i < n; i++)
+			{
+				const LineDesc& desc = lines[first + i];
+				vertices[i * 2 + 0] = { desc.from, PackColor(desc.fromColor) };
+				vertices[i * 2 + 1] = { desc.to, PackColor(desc.toColor) };
+			}
+		}
 
-	uint32_t requiredSize = lines.vertexCount + size;
-	if (requiredSize >= lines.maxLinesCount * 2)
-		lines.ResizeBuffer(requiredSize * 2);
+		first = last;
+	}
+}
 
+void Tiny2D::DrawLineList(Math::float3* points, uint32_t size, const Math::float4& color, float thickness)
+{
+	CORE_ASSERT(points);
 
 	if (size % 2 != 0)
 	{
@@ -1346,18 +3547,18 @@ void Tiny2D::DrawLineList(Math::float3* points, uint32_t size, const Math::float
 		return;
 	}
 
-	for (size_t i = 0; i < size - 1; i += 2)
-	{
-		lines.vertexBufferPtr->position = points[i];
-		lines.vertexBufferPtr->thickness = thickness;
-		lines.vertexBufferPtr->color = color;
-		lines.vertexBufferPtr++;
+	if (size == 0)
+		return;
 
-		lines.vertexBufferPtr->position = points[i + 1];
-		lines.vertexBufferPtr->color = color;
-		lines.vertexBufferPtr++;
+	LinePass::LineVertex* vertices = GetDrawContext()->line.Allocate(size, thickness);
+	if (!vertices)
+		return;
 
-		lines.vertexCount += 2;
+	uint32_t packedColor = PackColor(color);
+	for (uint32_t i = 0; i < size; i++)
+	{
+		vertices[i].position = points[i];
+		vertices[i].color = packedColor;
 	}
 }
 
@@ -1370,31 +3571,21 @@ void Tiny2D::DrawLineStrip(Math::float3* points, uint32_t size, const Math::floa
 {
 	CORE_ASSERT(points);
 
-	auto& lines = s_Data->fd->line;
-
-	uint32_t requiredSize = lines.vertexCount + size;
-	if (requiredSize >= lines.maxLinesCount * 2)
-		lines.ResizeBuffer(requiredSize * 2);
-
 	if (size < 2)
 	{
 		LOG_CORE_ERROR("at least 2 points are required, The input size is ({}).", size);
 		return;
 	}
 
-	for (size_t i = 0; i < size - 1; i++)
-	{
-		lines.vertexBufferPtr->position = points[i];
-		lines.vertexBufferPtr->thickness = thickness;
-		lines.vertexBufferPtr->color = color;
-		lines.vertexBufferPtr++;
-
-		lines.vertexBufferPtr->position = points[i + 1];
-		lines.vertexBufferPtr->thickness = thickness;
-		lines.vertexBufferPtr->color = color;
-		lines.vertexBufferPtr++;
+	LinePass::LineVertex* vertices = GetDrawContext()->line.AllocateStrip(size, thickness);
+	if (!vertices)
+		return;
 
-		lines.vertexCount += 2;
+	uint32_t packedColor = PackColor(color);
+	for (uint32_t i = 0; i < size; i++)
+	{
+		vertices[i].position = points[i];
+		vertices[i].color = packedColor;
 	}
 }
 
@@ -1405,43 +3596,15 @@ void Tiny2D::DrawLineStrip(std::span<Math::float3> span, const Math::float4& col
 
 void Tiny2D::DrawWireBox(const WireBoxDesc& desc)
 {
-	auto transform = ConstructTransformMatrix(desc.position, desc.rotation, desc.scale);
-
-	Math::float3 vertices[8] = {
-		Math::float3(-0.5f, -0.5f, -0.5f), // Bottom-left-front
-		Math::float3(0.5f, -0.5f, -0.5f),  // Bottom-right-front
-		Math::float3(0.5f, -0.5f,  0.5f),  // Bottom-right-back
-		Math::float3(-0.5f, -0.5f,  0.5f), // Bottom-left-back
-		Math::float3(-0.5f,  0.5f, -0.5f), // Top-left-front
-		Math::float3(0.5f,  0.5f, -0.5f),  // Top-right-front
-		Math::float3(0.5f,  0.5f,  0.5f),  // Top-right-back
-		Math::float3(-0.5f,  0.5f,  0.5f)  // Top-left-back
-	};
-
-	Math::float3 transformedVertices[8];
-	for (size_t i = 0; i < 8; i++)
-		transformedVertices[i] = Math::float3(transform * Math::float4(vertices[i], 1.0f));
-
-	// Define the line segments of the box
-	Math::float3 boxLines[24] = {
-		// Top edges
-		transformedVertices[4], transformedVertices[5],
-		transformedVertices[5], transformedVertices[6],
-		transformedVertices[6], transformedVertices[7],
-		transformedVertices[7], transformedVertices[4],
-		// Bottom edges
-		transformedVertices[0], transformedVertices[1],
-		transformedVertices[1], transformedVertices[2],
-		transformedVertices[2], transformedVertices[3],
-		transformedVertices[3], transformedVertices[0],
-		// Vertical edges
-		transformedVertices[0], transformedVertices[4],
-		transformedVertices[1], transformedVertices[5],
-		transformedVertices[2], transformedVertices[6],
-		transformedVertices[3], transformedVertices[7]
-	};
+	WireShapeAttributes* instance = GetDrawContext()->wire.Allocate(WireShape::Box);
+	if (!instance)
+		return;
 
-	Tiny2D::DrawLineList(boxLines, desc.color, desc.thickness);
+	instance->position = desc.position;
+	instance->rotation = desc.rotation;
+	instance->scale = desc.scale;
+	instance->color = desc.color;
+	instance->thickness = desc.thickness;
 }
 
 void Tiny2D::DrawWireSphere(const WireSphereDesc& desc)
@@ -1471,222 +3634,474 @@ void Tiny2D::DrawWireSphere(const WireSphereDesc& desc)
 	});
 }
 
-void Tiny2D::DrawWireCylinder(const WireCylinderDesc& desc)
+// coarsest level whose segments stay within the wire tolerance of the view from the circle of radius at position.
+// The sagitta of a segment spanning angle a of a circle of radius r is r * (1 - cos(a / 2))
+static uint32_t SelectWireLevel(const ViewData* viewData, const Math::float3& position, float radius)
 {
-	float r = desc.radius;
-	float halfHeight = desc.height * 0.5f;
+	constexpr uint32_t maxLevel = WirePass::c_LevelCount - 1;
 
-	Math::float3 topPos = desc.position + desc.rotation * Math::float3(0, halfHeight, 0);
-	Math::float3 bottomPos = desc.position + desc.rotation * Math::float3(0, -halfHeight, 0);
-	Math::float3 up = Math::normalize(topPos - bottomPos);
-	Math::float3 temp = (fabs(up.x) < 0.99f) ? Math::float3(1, 0, 0) : Math::float3(0, 0, 1);
-	Math::float3 right = Math::normalize(Math::cross(up, temp));
-	Math::float3 forward = Math::normalize(Math::cross(right, up));
+	// static batches are recorded without a view and drawn with any transform
+	if (!viewData || viewData->wireTolerance <= 0.0f)
+		return maxLevel;
 
-	{
-		Math::float3 p[8] = {
-			topPos + right * r, bottomPos + right * r,
-			topPos + forward * r, bottomPos + forward * r,
-			topPos - right * r, bottomPos - right * r,
-			topPos - forward * r, bottomPos - forward * r
-		};
+	const Math::float4x4& viewProj = viewData->viewConstants.ViewProjMatrix;
+	const Math::float2& viewSize = viewData->viewConstants.viewSize;
 
-		Tiny2D::DrawLineList(p, desc.color);
-	}
+	float w = (viewProj * Math::float4(position, 1.0f)).w;
+	if (w <= 1e-5f)
+		return maxLevel;
+
+	// pixels per world unit at the depth of the shape, from the rows of the projection that produce clip x and y
+	float pixelsX = Math::length(Math::float3(viewProj[0][0], viewProj[1][0], viewProj[2][0])) * viewSize.x;
+	float pixelsY = Math::length(Math::float3(viewProj[0][1], viewProj[1][1], viewProj[2][1])) * viewSize.y;
+	float radiusPixels = radius * Math::max(pixelsX, pixelsY) * 0.5f / w;
 
-	auto drawFullCircle = [&](Math::float3 center, Math::float3 axis) {
-		Math::float3 points[33];
+	for (uint32_t level = 0; level < maxLevel; level++)
+	{
+		float error = radiusPixels * (1.0f - cosf(Math::pi<float>() / WirePass::CircleSegments(level)));
+		if (error <= viewData->wireTolerance)
+			return level;
+	}
 
-		Math::float3 tangent = Math::normalize(Math::cross(axis, right));
-		if (Math::length2(tangent) < 1e-4f) tangent = Math::normalize(Math::cross(axis, forward));
-		Math::float3 bitangent = Math::normalize(Math::cross(axis, tangent));
+	return maxLevel;
+}
 
-		constexpr float step = Math::two_pi<float>() / 32.0f;
-		
-		for (int i = 0; i <= 32; i++)
-			points[i] = center + (cos(i * step) * tangent + sin(i * step) * bitangent) * r;
+// the round shapes keep the 1 pixel lines they had as line lists, desc.thickness is not in pixels
+void Tiny2D::DrawWireCylinder(const WireCylinderDesc& desc)
+{
+	Tiny2D::DrawContext* context = GetDrawContext();
+	uint32_t level = SelectWireLevel(context->view, desc.position, desc.radius);
 
-		Tiny2D::DrawLineStrip(points, desc.color);
-	};
+	WireShapeAttributes* instance = context->wire.Allocate(WireShape::Cylinder, level);
+	if (!instance)
+		return;
 
-	drawFullCircle(topPos, up);
-	drawFullCircle(bottomPos, up);
+	instance->position = desc.position;
+	instance->rotation = desc.rotation;
+	instance->scale = { desc.radius, desc.height, 0.0f };
+	instance->color = desc.color;
+	instance->thickness = 1.0f;
 }
 
 void Tiny2D::DrawWireCapsule(const WireCapsuleDesc& desc)
 {
-	float r = desc.radius;
-	float halfHeight = desc.height * 0.5f;
+	Tiny2D::DrawContext* context = GetDrawContext();
+	uint32_t level = SelectWireLevel(context->view, desc.position, desc.radius);
+
+	WireShapeAttributes* instance = context->wire.Allocate(WireShape::Capsule, level);
+	if (!instance)
+		return;
+
+	instance->position = desc.position;
+	instance->rotation = desc.rotation;
+	instance->scale = { desc.radius, desc.height, 0.0f };
+	instance->color = desc.color;
+	instance->thickness = 1.0f;
+}
 
-	Math::float3 topPos = desc.position + desc.rotation * Math::float3(0, halfHeight, 0);
-	Math::float3 bottomPos = desc.position + desc.rotation * Math::float3(0, -halfHeight, 0);
-	Math::float3 up = Math::normalize(topPos - bottomPos);
-	Math::float3 temp = (fabs(up.x) < 0.99f) ? Math::float3(1, 0, 0) : Math::float3(0, 0, 1);
-	Math::float3 right = Math::normalize(Math::cross(up, temp));
-	Math::float3 forward = Math::normalize(Math::cross(right, up));
+// transforms every vertex of a mesh once into a per-thread scratch buffer, the columns are loaded up front
+// so the loop is plain multiply-adds the compiler vectorizes
+static const Math::float3* TransformVertices(const Math::float4x4& wt, const Math::float3* vertices, size_t vertexCount)
+{
+	static thread_local std::vector<Math::float3> t_Positions;
+	t_Positions.resize(vertexCount);
 
+	const Math::float3 x(wt[0]), y(wt[1]), z(wt[2]), w(wt[3]);
+	for (size_t i = 0; i < vertexCount; i++)
 	{
-		Math::float3 p[8] = {
-			topPos + right * r, bottomPos + right * r,
-			topPos + forward * r, bottomPos + forward * r,
-			topPos - right * r, bottomPos - right * r,
-			topPos - forward * r, bottomPos - forward * r
-		};
-		Tiny2D::DrawLineList(p, desc.color);
+		const Math::float3& v = vertices[i];
+		t_Positions[i] = x * v.x + y * v.y + z * v.z + w;
 	}
 
-	auto drawFullCircle = [&](Math::float3 center, Math::float3 axis) {
+	return t_Positions.data();
+}
 
-		Math::float3 points[33];
+// edge(i, a, b) returns the vertex indices of edge i, written as line lists in chunks a memory budget can hold
+template<typename F>
+static void WriteEdges(const Math::float3* positions, size_t edgeCount, const Math::float4& color, F&& edge)
+{
+	constexpr size_t c_ChunkSize = 4096;
 
-		Math::float3 tangent = Math::normalize(Math::cross(axis, right));
-		if (Math::length2(tangent) < 1e-4f) tangent = Math::normalize(Math::cross(axis, forward));
-		Math::float3 bitangent = Math::normalize(Math::cross(axis, tangent));
+	LinePass& line = GetDrawContext()->line;
+	uint32_t packedColor = PackColor(color);
 
-		constexpr float step = Math::two_pi<float>() / 32.0f;
+	for (size_t first = 0; first < edgeCount; first += c_ChunkSize)
+	{
+		uint32_t n = (uint32_t)Math::min(c_ChunkSize, edgeCount - first);
 
-		for (int i = 0; i <= 32; i++)
-			points[i] = center + (cos(i * step) * tangent + sin(i * step) * bitangent) * r;
+		LinePass::LineVertex* vertices = line.Allocate(n * 2, 1.0f);
+		if (!vertices)
+			continue;
 
-		Tiny2D::DrawLineStrip(points, desc.color);
-	};
+		for (uint32_t i = 0; i < n; i++)
+		{
+			uint32_t a, b;
+			edge(first + i, a, b);
 
-	drawFullCircle(topPos, up);
-	drawFullCircle(bottomPos, up);
-
-	auto drawHalfCircle = [&](Math::float3 axis) {
-		
-		Math::float3 points[17];
-		Math::float3 tangent = Math::normalize(Math::cross(axis, up));
-		if (Math::length2(tangent) < 1e-4f) tangent = Math::normalize(Math::cross(axis, right));
-		Math::float3 bitangent = Math::normalize(Math::cross(axis, tangent));
-		
-		constexpr float step = Math::two_pi<float>() / 32.0f;
-
-		for (int i = 32; i >= 16; i--)
-			points[32 - i] = topPos + (cos(i * step) * tangent + sin(i * step) * bitangent) * r;
-		
-		Tiny2D::DrawLineStrip(points, desc.color);
-
-		for (int i = 0; i < 17; i++)
-			points[i] = bottomPos + (cos(i * step) * tangent + sin(i * step) * bitangent) * r;
-		
-		Tiny2D::DrawLineStrip(points, desc.color);
-	};
+			vertices[i * 2 + 0] = { positions[a], packedColor };
+			vertices[i * 2 + 1] = { positions[b], packedColor };
+		}
+	}
+}
 
-	drawHalfCircle(right);
-	drawHalfCircle(forward);
+// index of corner k of triangle t, non-indexed meshes use consecutive vertices
+static uint32_t TriangleIndex(const uint32_t* indices, size_t t, size_t k)
+{
+	return indices ? indices[t * 3 + k] : uint32_t(t * 3 + k);
 }
 
 void Tiny2D::DrawMeshWireframe(Math::float4x4 wt, const Math::float3* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, const Math::vec4& color)
 {
-	if (indices && indexCount >= 3)
+	size_t triangleCount = (indices && indexCount >= 3) ? indexCount / 3 : vertexCount / 3;
+	if (!indices || indexCount < 3)
+		indices = nullptr;
+
+	const Math::float3* positions = TransformVertices(wt, vertices, vertexCount);
+
+	WriteEdges(positions, triangleCount * 3, color, [&](size_t i, uint32_t& a, uint32_t& b) {
+		size_t t = i / 3, k = i % 3;
+		a = TriangleIndex(indices, t, k);
+		b = TriangleIndex(indices, t, (k + 1) % 3);
+	});
+}
+
+static std::vector<uint32_t> BuildUniqueEdges(const uint32_t* indices, size_t triangleCount)
+{
+	CORE_PROFILE_SCOPE_NC("Tiny2D::BuildUniqueEdges", RENDERING_COLOR);
+
+	// both directions of an edge share the key of its sorted indices
+	std::vector<uint64_t> keys;
+	keys.reserve(triangleCount * 3);
+
+	for (size_t t = 0; t < triangleCount; t++)
 	{
-		for (size_t i = 0; i < indexCount; i += 3)
+		for (size_t k = 0; k < 3; k++)
 		{
-			Math::float3 a = Transform(vertices[indices[i + 0]], wt);
-			Math::float3 b = Transform(vertices[indices[i + 1]], wt);
-			Math::float3 c = Transform(vertices[indices[i + 2]], wt);
-
-			Tiny2D::DrawLine({ .from = a, .to = b, .fromColor = color, .toColor = color });
-			Tiny2D::DrawLine({ .from = b, .to = c, .fromColor = color, .toColor = color });
-			Tiny2D::DrawLine({ .from = c, .to = a, .fromColor = color, .toColor = color });
+			uint32_t a = TriangleIndex(indices, t, k);
+			uint32_t b = TriangleIndex(indices, t, (k + 1) % 3);
+			keys.push_back(uint64_t(Math::min(a, b)) << 32 | Math::max(a, b));
 		}
 	}
-	else
+
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	std::vector<uint32_t> edges(keys.size() * 2);
+	for (size_t i = 0; i < keys.size(); i++)
 	{
-		for (size_t i = 0; i + 2 < vertexCount; i += 3)
-		{
-			Math::float3 a = Transform(vertices[i + 0], wt);
-			Math::float3 b = Transform(vertices[i + 1], wt);
-			Math::float3 c = Transform(vertices[i + 2], wt);
+		edges[i * 2 + 0] = uint32_t(keys[i] >> 32);
+		edges[i * 2 + 1] = uint32_t(keys[i]);
+	}
+
+	return edges;
+}
+
+void Tiny2D::DrawMeshWireframe(uint64_t key, Math::float4x4 wt, const Math::float3* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, const Math::vec4& color)
+{
+	size_t triangleCount = (indices && indexCount >= 3) ? indexCount / 3 : vertexCount / 3;
+	if (!indices || indexCount < 3)
+		indices = nullptr;
+
+	size_t cachedIndexCount = indices ? indexCount : vertexCount;
+
+	std::shared_ptr<const std::vector<uint32_t>> edges;
+	{
+		std::shared_lock<std::shared_mutex> lock(s_Data->wireframeMutex);
+
+		auto it = s_Data->wireframes.find(key);
+		if (it != s_Data->wireframes.end() && it->second.indexCount == cachedIndexCount)
+			edges = it->second.edges;
+	}
+
+	if (!edges)
+	{
+		auto built = std::make_shared<const std::vector<uint32_t>>(BuildUniqueEdges(indices, triangleCount));
 
-			Tiny2D::DrawLine({ .from = a, .to = b, .fromColor = color, .toColor = color });
-			Tiny2D::DrawLine({ .from = b, .to = c, .fromColor = color, .toColor = color });
-			Tiny2D::DrawLine({ .from = c, .to = a, .fromColor = color, .toColor = color });
+		// another thread may have missed the same key and stored its edges first, keep those
+		std::unique_lock<std::shared_mutex> lock(s_Data->wireframeMutex);
+		auto& entry = s_Data->wireframes[key];
+		if (!entry.edges || entry.indexCount != cachedIndexCount)
+		{
+			entry.indexCount = cachedIndexCount;
+			entry.edges = std::move(built);
 		}
+		edges = entry.edges;
 	}
+
+	const Math::float3* positions = TransformVertices(wt, vertices, vertexCount);
+	const uint32_t* edgeIndices = edges->data();
+
+	WriteEdges(positions, edges->size() / 2, color, [&](size_t i, uint32_t& a, uint32_t& b) {
+		a = edgeIndices[i * 2 + 0];
+		b = edgeIndices[i * 2 + 1];
+	});
+}
+
+void Tiny2D::ReleaseMeshWireframe(uint64_t key)
+{
+	std::unique_lock<std::shared_mutex> lock(s_Data->wireframeMutex);
+	s_Data->wireframes.erase(key);
 }
 
-void Tiny2D::DrawAABB(const AABBDesc& aabb)
+void Tiny2D::DrawMeshWireframe(const MeshWireframeDesc& desc)
 {
-	Math::float3 shift = Math::abs(aabb.max - aabb.min);
+	CORE_ASSERT(desc.vertexBuffer);
+	CORE_ASSERT(!desc.indexBuffer || desc.indexFormat == nvrhi::Format::R16_UINT || desc.indexFormat == nvrhi::Format::R32_UINT);
 
-	Math::float3 top1 = aabb.max;
-	Math::float3 top2 = aabb.max - Math::float3(shift.x, 0.0f, 0.0f);
-	Math::float3 top3 = aabb.max - Math::float3(shift.x, 0.0f, shift.z);
-	Math::float3 top4 = aabb.max - Math::float3(0.0f, 0.0f, shift.z);
+	if (desc.triangleCount == 0)
+		return;
 
-	Math::float3 bottom1 = aabb.min + Math::float3(shift.x, 0.0f, shift.z);
-	Math::float3 bottom2 = aabb.min + Math::float3(0.0f, 0.0f, shift.z);
-	Math::float3 bottom3 = aabb.min;
-	Math::float3 bottom4 = aabb.min + Math::float3(shift.x, 0.0f, 0.0f);
+	MeshWireframePass& pass = GetDrawContext()->meshWireframe;
 
-	Math::float3 boxLines[24] = {
-		top1, top2, top2, top3, top3, top4, top4, top1,
-		bottom1, bottom2, bottom2, bottom3, bottom3, bottom4, bottom4, bottom1,
-		top1, bottom1, top2, bottom2, top3 , bottom3, top4, bottom4 // Vertical lines
+	MeshWireframePass::Draw& draw = pass.draws.emplace_back();
+	draw.vertexBuffer = desc.vertexBuffer;
+	draw.indexBuffer = desc.indexBuffer;
+	draw.triangleCount = desc.triangleCount;
+	draw.constants = {
+		.transform = desc.transform,
+		.color = desc.color,
+		.vertexOffset = desc.vertexOffset,
+		.vertexStride = desc.vertexStride,
+		.indexOffset = desc.indexOffset,
+		.indexSize = desc.indexBuffer ? (desc.indexFormat == nvrhi::Format::R16_UINT ? 2u : 4u) : 0u,
+		.thickness = desc.thickness,
 	};
 
-	Tiny2D::DrawLineList(boxLines, aabb.color, aabb.thickness);
+	pass.edgeCount += desc.triangleCount * 3;
 }
 
-void Tiny2D::DrawBox(const Tiny2D::BoxDesc& desc)
+static void WriteAABB(AABBAttributes& instance, const Tiny2D::AABBDesc& desc, uint32_t color)
 {
-	auto& box = s_Data->fd->box;
+	instance.min = desc.min;
+	instance.max = desc.max;
+	instance.color = color;
+	instance.thickness = desc.thickness;
+}
 
-	if (box.instanceCount >= box.maxInstanceCount)
-		box.ResizeBuffer();
-	{
-		box.instanceDataPtr->position = desc.position;
-		box.instanceDataPtr->rotation = desc.rotation;
-		box.instanceDataPtr->scale = desc.scale;
-		box.instanceDataPtr->color = desc.color;
-		box.instanceDataPtr++;
+void Tiny2D::DrawAABB(const AABBDesc& desc)
+{
+	AABBAttributes* instance = GetDrawContext()->aabb.instances.Allocate(1);
+	if (!instance)
+		return;
+
+	WriteAABB(*instance, desc, PackColor(desc.color));
+}
+
+void Tiny2D::DrawAABBs(std::span<const AABBDesc> boxes)
+{
+	WriteInstances(GetDrawContext()->aabb.instances, boxes.size(), [&](AABBAttributes* instances, size_t first, uint32_t n) {
+		for (uint32_t i = 0; i < n; i++)
+			WriteAABB(instances[i], boxes[first + i], PackColor(boxes[first + i].color));
+	});
+}
 
-		box.instanceCount++;
+void Tiny2D::DrawAABBs(std::span<const AABBDesc> boxes, const AABBColorRamp& ramp)
+{
+	uint32_t levelCount = Math::max(ramp.levelCount, 1u);
+
+	std::vector<uint32_t> colors(levelCount);
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		float t = levelCount > 1 ? float(level) / float(levelCount - 1) : 0.0f;
+		colors[level] = PackColor(Math::mix(ramp.root, ramp.leaf, t));
 	}
+
+	WriteInstances(GetDrawContext()->aabb.instances, boxes.size(), [&](AABBAttributes* instances, size_t first, uint32_t n) {
+		for (uint32_t i = 0; i < n; i++)
+		{
+			const AABBDesc& desc = boxes[first + i];
+			WriteAABB(instances[i], desc, colors[Math::min(desc.level, levelCount - 1)]);
+		}
+	});
+}
+
+static BoxInstance MakeBoxInstance(const Tiny2D::BoxDesc& desc)
+{
+	BoxInstance instance;
+	instance.position = desc.position;
+	instance.rotation = desc.rotation;
+	instance.scale = desc.scale;
+	instance.color = desc.color;
+
+	return instance;
+}
+
+static SpriteInstance MakeSpriteInstance(const Tiny2D::QuadDesc& desc, int textureID)
+{
+	SpriteInstance instance;
+	instance.position = desc.position;
+	instance.rotation = desc.rotation;
+	instance.scale = desc.scale;
+	instance.uv = { desc.minUV.x, desc.minUV.y, desc.maxUV.x, desc.maxUV.y };
+	instance.color = desc.color;
+	instance.textureID = textureID;
+	instance.id = desc.id;
+
+	return instance;
+}
+
+static CircleInstance MakeCircleInstance(const Tiny2D::CircleDesc& desc)
+{
+	CircleInstance instance;
+	instance.position = desc.position;
+	instance.radius = desc.radius;
+	instance.rotation = desc.rotation;
+	instance.color = desc.color;
+	instance.thickness = desc.thickness;
+
+	return instance;
+}
+
+static int GetTextureDescriptor(nvrhi::ITexture* texture)
+{
+	return texture ? s_Data->descriptorTableManager.CreateDescriptor(nvrhi::BindingSetItem::Texture_SRV(0, texture)) : 0;
+}
+
+void Tiny2D::DrawBox(const Tiny2D::BoxDesc& desc)
+{
+	Tiny2D::DrawContext* context = GetDrawContext();
+	WriteInstance(context->box, context->packedBox, MakeBoxInstance(desc));
+}
+
+void Tiny2D::DrawBoxes(std::span<const BoxDesc> boxes)
+{
+	Tiny2D::DrawContext* context = GetDrawContext();
+	WriteInstances(context->box, context->packedBox, boxes.size(), [&](size_t i) {
+		return MakeBoxInstance(boxes[i]);
+	});
 }
 
 void Tiny2D::DrawQuad(const Tiny2D::QuadDesc& desc)
 {
-	int textureID = desc.texture ? s_Data->descriptorTableManager.CreateDescriptor(nvrhi::BindingSetItem::Texture_SRV(0, desc.texture)) : 0;
+	int textureID = GetTextureDescriptor(desc.texture);
 
-	auto& sprite = s_Data->fd->sprite;
+	Tiny2D::DrawContext* context = GetDrawContext();
+	WriteInstance(context->sprite, context->packedSprite, MakeSpriteInstance(desc, textureID));
+}
 
-	if (sprite.instanceCount >= sprite.maxInstanceCount)
-		sprite.ResizeBuffer();
+void Tiny2D::DrawQuads(std::span<const QuadDesc> quads)
+{
+	Tiny2D::DrawContext* context = GetDrawContext();
 
-	{
-		sprite.instanceDataPtr->position = desc.position;
-		sprite.instanceDataPtr->rotation = desc.rotation;
-		sprite.instanceDataPtr->scale = desc.scale;
-		sprite.instanceDataPtr->uv = { desc.minUV.x, desc.minUV.y, desc.maxUV.x, desc.maxUV.y };
-		sprite.instanceDataPtr->color = desc.color;
-		sprite.instanceDataPtr->textureID = textureID;
-		sprite.instanceDataPtr->id = desc.id;
-		sprite.instanceDataPtr++;
+	// neighbouring quads mostly share a texture, its descriptor is only looked up when it changes
+	nvrhi::ITexture* texture = nullptr;
+	int textureID = 0;
 
-		sprite.instanceCount++;
-	}
+	WriteInstances(context->sprite, context->packedSprite, quads.size(), [&](size_t i) {
+		const QuadDesc& desc = quads[i];
+		if (desc.texture != texture)
+		{
+			texture = desc.texture;
+			textureID = GetTextureDescriptor(texture);
+		}
+
+		return MakeSpriteInstance(desc, textureID);
+	});
 }
 
 void Tiny2D::DrawCircle(const Tiny2D::CircleDesc& desc)
 {
-	auto& circle = s_Data->fd->circle;
+	Tiny2D::DrawContext* context = GetDrawContext();
+	WriteInstance(context->circle, context->packedCircle, MakeCircleInstance(desc));
+}
 
-	if (circle.instanceCount >= circle.maxInstanceCount)
-		circle.ResizeBuffer();
-	{
-		circle.instanceDataPtr->position = desc.position;
-		circle.instanceDataPtr->radius = desc.radius;
-		circle.instanceDataPtr->rotation = desc.rotation;
-		circle.instanceDataPtr->color = desc.color;
-		circle.instanceDataPtr->thickness = desc.thickness;
-		circle.instanceDataPtr++;
+void Tiny2D::DrawCircles(std::span<const CircleDesc> circles)
+{
+	Tiny2D::DrawContext* context = GetDrawContext();
+	WriteInstances(context->circle, context->packedCircle, circles.size(), [&](size_t i) {
+		return MakeCircleInstance(circles[i]);
+	});
+}
 
-		circle.instanceCount++;
-	}
+void Tiny2D::DrawQuads(const QuadStreams& streams)
+{
+	size_t count = streams.positions.size();
+	CORE_ASSERT(streams.colors.empty() || streams.colors.size() >= count);
+	CORE_ASSERT(streams.scales.empty() || streams.scales.size() >= count);
+	CORE_ASSERT(streams.rotations.empty() || streams.rotations.size() >= count);
+
+	Tiny2D::DrawContext* context = GetDrawContext();
+
+	SpriteInstance uniform;
+	uniform.uv = { streams.minUV.x, streams.minUV.y, streams.maxUV.x, streams.maxUV.y };
+	uniform.textureID = GetTextureDescriptor(streams.texture);
+	uniform.id = streams.id;
+
+	WriteInstances(context->sprite, context->packedSprite, count, [&](size_t i) {
+		SpriteInstance instance = uniform;
+		instance.position = streams.positions[i];
+		instance.rotation = StreamElement(streams.rotations, streams.rotation, i);
+		instance.scale = StreamElement(streams.scales, streams.scale, i);
+		instance.color = StreamElement(streams.colors, streams.color, i);
+
+		return instance;
+	});
+}
+
+void Tiny2D::DrawCircles(const CircleStreams& streams)
+{
+	size_t count = streams.positions.size();
+	CORE_ASSERT(streams.colors.empty() || streams.colors.size() >= count);
+	CORE_ASSERT(streams.radii.empty() || streams.radii.size() >= count);
+	CORE_ASSERT(streams.rotations.empty() || streams.rotations.size() >= count);
+
+	Tiny2D::DrawContext* context = GetDrawContext();
+
+	WriteInstances(context->circle, context->packedCircle, count, [&](size_t i) {
+		CircleInstance instance;
+		instance.position = streams.positions[i];
+		instance.radius = StreamElement(streams.radii, streams.radius, i);
+		instance.rotation = StreamElement(streams.rotations, streams.rotation, i);
+		instance.color = StreamElement(streams.colors, streams.color, i);
+		instance.thickness = streams.thickness;
+
+		return instance;
+	});
+}
+
+void Tiny2D::DrawQuad2D(const Quad2DDesc& desc)
+{
+	int textureID = GetTextureDescriptor(desc.texture);
+
+	if (Sprite2DAttributes* attributes = GetDrawContext()->sprite2D.instances.Allocate(1))
+		*attributes = Sprite2DAttributes::Pack(desc, textureID);
+}
+
+void Tiny2D::DrawCircle2D(const Circle2DDesc& desc)
+{
+	if (Circle2DAttributes* attributes = GetDrawContext()->circle2D.instances.Allocate(1))
+		*attributes = Circle2DAttributes::Pack(desc);
+}
+
+void Tiny2D::DrawQuads2D(std::span<const Quad2DDesc> quads)
+{
+	Tiny2D::DrawContext* context = GetDrawContext();
+
+	nvrhi::ITexture* texture = nullptr;
+	int textureID = 0;
+
+	WriteInstances(context->sprite2D.instances, quads.size(), [&](Sprite2DAttributes* instances, size_t first, uint32_t n) {
+		for (uint32_t i = 0; i < n; i++)
+		{
+			const Quad2DDesc& desc = quads[first + i];
+			if (desc.texture != texture)
+			{
+				texture = desc.texture;
+				textureID = GetTextureDescriptor(texture);
+			}
+
+			instances[i] = Sprite2DAttributes::Pack(desc, textureID);
+		}
+	});
+}
+
+void Tiny2D::DrawCircles2D(std::span<const Circle2DDesc> circles)
+{
+	Tiny2D::DrawContext* context = GetDrawContext();
+	WriteInstances(context->circle2D.instances, circles.size(), [&](Circle2DAttributes* instances, size_t first, uint32_t n) {
+		for (uint32_t i = 0; i < n; i++)
+			instances[i] = Circle2DAttributes::Pack(circles[first + i]);
+	});
 }
 
 void Tiny2D::DrawText(const TextDesc& desc)
@@ -1694,11 +4109,11 @@ void Tiny2D::DrawText(const TextDesc& desc)
 	auto& font = s_Data->defaultFont;
 	if (!font) return;
 
-	auto& text = s_Data->fd->text;
-
-	uint32_t requiredSize = text.instanceCount + (uint32_t)desc.text.size();
-	if (requiredSize >= text.maxInstanceCount)
-		text.ResizeBuffer(requiredSize * 2);
+	Tiny2D::DrawContext* context = GetDrawContext();
+	if (s_Data->packedInstances)
+		context->packedText.instances.Reserve((uint32_t)desc.text.size());
+	else
+		context->text.instances.Reserve((uint32_t)desc.text.size());
 
 	int textureID = s_Data->descriptorTableManager.CreateDescriptor(nvrhi::BindingSetItem::Texture_SRV(0, font->atlasTexture));
 
@@ -1756,15 +4171,15 @@ void Tiny2D::DrawText(const TextDesc& desc)
 		Math::float3 worldPos = desc.position + desc.rotation * Math::float3(center, 0.0f) * desc.scale;
 		Math::float3 worldScale = Math::float3(size, 1.0f) * desc.scale;
 
-		text.instanceDataPtr->position = worldPos;
-		text.instanceDataPtr->rotation = desc.rotation;
-		text.instanceDataPtr->scale = worldScale;
-		text.instanceDataPtr->color = desc.color;
-		text.instanceDataPtr->uv = { texCoordMin, texCoordMax };
-		text.instanceDataPtr->textureID = textureID;
-		text.instanceDataPtr++;
+		TextInstance instance;
+		instance.position = worldPos;
+		instance.rotation = desc.rotation;
+		instance.scale = worldScale;
+		instance.color = desc.color;
+		instance.uv = { texCoordMin, texCoordMax };
+		instance.textureID = textureID;
 
-		text.instanceCount++;
+		WriteInstance(context->text, context->packedText, instance);
 
 		if (i < desc.text.size() - 1)
 		{